@@ -124,6 +124,14 @@ void BST<T>::remove(const T& value) {
  */
 template <typename T>
 void BST<T>::clear() {
+    // an arena gets its blocks back all at once, skip the per-node frees
+    if (allocator_ != nullptr && allocator_->getConfig().isArena) {
+        if (!std::is_trivially_destructible<BinTreeNode>::value) {
+            destroy_(root_);
+        }
+        root_ = nullptr;
+        return;
+    }
     while (!isEmpty(root_)) {
         // Remove all elements in the tree
         remove_(root_, root_->data);
@@ -506,6 +514,21 @@ void BST<T>::remove_(BinTree& tree, const T& value) {
     }
 }
 
+/**
+ * @brief A recursive step to destroy the nodes of a tree without
+ *        freeing them (arena mode)
+ * @param tree The tree to be destroyed
+ */
+template <typename T>
+void BST<T>::destroy_(BinTree tree) {
+    if (tree == nullptr) {
+        return;
+    }
+    destroy_(tree->left);
+    destroy_(tree->right);
+    tree->~BinTreeNode();
+}
+
 /**
  * @brief A recursive step to copy the tree 
  * @param tree The tree to be copied
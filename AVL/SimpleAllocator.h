@@ -12,6 +12,9 @@
 #define SIMPLEALLOCATOR_H
 #include <string>
 #include <iostream>
+#include <vector>
+
+class SimpleWorkloadRecorder;
 
 // Defaults for SimpleAllocator construction when client does not specify
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;
@@ -145,7 +148,8 @@ struct SimpleAllocatorConfig {
         leftAlignBytesSize(0),
         interAlignBytesSize(0),
         padBytesSize(_padBytesSize), 
-        isDebug(_isDebug){}
+        isDebug(_isDebug),
+        isArena(false){}
 
     bool useCPPMemManager; // Use C++ memory manager (operator new) instead of malloc
     unsigned objectsPerPage; // Number of objects per page
@@ -156,6 +160,7 @@ struct SimpleAllocatorConfig {
     unsigned interAlignBytesSize; // num bytes in inter alignment (computed from alignmentBoundary)
     unsigned padBytesSize; // num bytes in padding
     bool isDebug; // True if debug mode is on
+    bool isArena; // True if the client drops all blocks at once with reset() or releaseAll(), so containers skip their per-block frees
 };
 
 /**
@@ -249,6 +254,19 @@ public:
      */
     void free(void* pObj);
 
+    /**
+     * Free every block at once, keeping the chunks to carve them again
+     * (arena mode only, the blocks of new are not kept track of)
+     * @return number of blocks freed
+     */
+    unsigned reset();
+
+    /**
+     * Free every block at once and delete the chunks (arena mode only)
+     * @return number of chunks released
+     */
+    unsigned releaseAll();
+
     /**
      * Get the configuration parameters struct
      * @return configuration parameters
@@ -270,6 +288,14 @@ private:
     // - feel free to add your own private stuff
     SimpleAllocatorConfig config_; // Configuration parameters
     SimpleAllocatorStats stats_; // Configuration parameters
+    SimpleWorkloadRecorder* pRecorder_; // workload recorder of SIMPLEALLOCATOR_RECORD (nullptr if not recording)
+    unsigned recorderStream_; // this allocator's stream in pRecorder_
+
+    // Arena mode: blocks are carved out of chunks of objectsPerPage blocks
+    std::vector<char*> chunks_; // every chunk, carved in order
+    size_t chunk_; // chunk being carved
+    unsigned carved_; // blocks carved off it so far
+    Node* pFreeList_; // blocks freed since the last reset
 };
 
 #endif // SIMPLEALLOCATOR_H
@@ -529,6 +529,27 @@ int main(int argc, char* argv[]) {
         inorderSS = avl.printInorder();
         cout << "Inorder traversal: " << inorderSS.str() << endl;
         break;
+    case 7:
+        cout << "=== Test clear(ing) an AVL tree in an arena allocator ===" << endl;
+        {
+            // nodes are carved out of chunks, and clear() leaves them there
+            SimpleAllocatorConfig config;
+            config.objectsPerPage = 64;
+            config.isArena = true;
+            SimpleAllocator allocator(sizeof(AVL<int>::BinTreeNode), config);
+            AVL<int> arenaAVL(&allocator);
+            addInts<int>(arenaAVL, 100, false, true);
+            removeInts<int>(arenaAVL, false, 10, false, true);
+            removeInts<int>(arenaAVL, true);
+            cout << "blocks out: " << allocator.getStats().allocations
+                 << ", frees: " << allocator.getStats().deallocations << endl;
+            cout << "reset freed " << allocator.reset() << " blocks" << endl;
+            cout << endl;
+
+            // the tree is built again in the same chunks
+            addInts<int>(arenaAVL, 8);
+        }
+        break;
     default:
         cout << "Please select a valid test." << endl;
         break;
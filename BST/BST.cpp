@@ -70,6 +70,14 @@ void BST<T>::remove(const T& value) {
 
 template <typename T>
 void BST<T>::clear() {
+    // an arena gets its blocks back all at once, skip the per-node frees
+    if (allocator_ != nullptr && allocator_->getConfig().isArena) {
+        if (!std::is_trivially_destructible<BinTreeNode>::value) {
+            destroy_(root_);
+        }
+        root_ = nullptr;
+        return;
+    }
     while (!isEmpty(root_)) {
         // Remove all elements in the tree
         remove_(root_, root_->data);
@@ -340,6 +348,16 @@ int BST<T>::height_(const BinTree& tree) const {
     return treeHeight(tree);
 }
 
+template <typename T>
+void BST<T>::destroy_(BinTree tree) {
+    if (tree == nullptr) {
+        return;
+    }
+    destroy_(tree->left);
+    destroy_(tree->right);
+    tree->~BinTreeNode();
+}
+
 template <typename T>
 void BST<T>::copy_(BinTree& tree, const BinTree& rtree) {
     if (rtree == nullptr) {
@@ -12,6 +12,7 @@
 #include "SimpleAllocator.h" // to use your SimpleAllocator
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
 /**
  * @class BSTException
@@ -134,6 +135,9 @@ class BST {
 
     /**
      * @brief Remove all nodes in the tree
+     *        With an allocator in arena mode the nodes are not freed one
+     *        by one, only destroyed; the client takes them back all at once
+     *        with the allocator's reset() or releaseAll()
      */
     void clear();
 
@@ -284,6 +288,13 @@ class BST {
      * @param rtree The tree to be copied to
      */
     void copy_(BinTree& tree, const BinTree& rtree);
+
+    /**
+     * @brief A recursive step to destroy the nodes of a tree without
+     *        freeing them (arena mode)
+     * @param tree The tree to be destroyed
+     */
+    void destroy_(BinTree tree);
 };
 
 // This is the header file but it is including the implemention cpp because
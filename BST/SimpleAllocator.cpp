@@ -6,29 +6,70 @@
 
 // #define DEBUG
 #include "SimpleAllocator.h"
+#include "SimpleWorkload.h"
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 
 SimpleAllocator::SimpleAllocator(size_t objectSize,
                                  const SimpleAllocatorConfig& config)
-    : config_(config), stats_{}{
+    : config_(config), stats_{}, pRecorder_(nullptr), recorderStream_(0),
+      chunk_(0), carved_(0), pFreeList_(nullptr){
     stats_.objectSize = objectSize;
     config_.useCPPMemManager = true; // always true for this dummy allocator
+
+    // record the calls if SIMPLEALLOCATOR_RECORD names a file, so that they
+    // can be replayed against the real allocator ("Simple Allocator"/replay)
+    pRecorder_ = SimpleWorkloadRecorder::fromEnvironment();
+    if (pRecorder_ != nullptr) {
+        recorderStream_ = pRecorder_->addStream(objectSize);
+    }
 }
 
 SimpleAllocator::~SimpleAllocator() {
+    releaseAll();
 }
 
 void* SimpleAllocator::allocate(const char* pLabel) {
     // use cpp mem manager if enabled
-    if (config_.useCPPMemManager) {
+    if (config_.isArena) {
+        ++stats_.allocations;
+        ++stats_.mostObjects;
+
+        // recycle a freed block, or carve one off the current chunk
+        char* pObject = nullptr;
+        if (pFreeList_ != nullptr) {
+            pObject = reinterpret_cast<char*>(pFreeList_);
+            pFreeList_ = pFreeList_->pNext;
+        } else {
+            // blocks must be able to hold the free list link
+            size_t blockSize = stats_.objectSize < sizeof(Node) ? sizeof(Node) : stats_.objectSize;
+            unsigned perChunk = config_.objectsPerPage > 0 ? config_.objectsPerPage : 1;
+            if (carved_ == perChunk) {
+                ++chunk_;
+                carved_ = 0;
+            }
+            if (chunk_ == chunks_.size()) {
+                chunks_.push_back(new char[blockSize * perChunk]);
+            }
+            pObject = chunks_[chunk_] + blockSize * carved_++;
+        }
+        if (pRecorder_ != nullptr) {
+            pRecorder_->recordAllocate(recorderStream_, pObject);
+        }
+        return pObject;
+    }
+    else if (config_.useCPPMemManager) {
         // update stats assuming allocation succeeds
         ++stats_.allocations;
         ++stats_.mostObjects;
 
         // return exact number of bytes requested using char
-        return new char[stats_.objectSize];
+        char* pObject = new char[stats_.objectSize];
+        if (pRecorder_ != nullptr) {
+            pRecorder_->recordAllocate(recorderStream_, pObject);
+        }
+        return pObject;
     }
     else {
         // this is supposed to be the custom allocation code but this is a dummy
@@ -38,7 +79,24 @@ void* SimpleAllocator::allocate(const char* pLabel) {
 }
 
 void SimpleAllocator::free(void* pObject) {
-    if (config_.useCPPMemManager) {
+    if (config_.isArena) {
+        if (pRecorder_ != nullptr) {
+            pRecorder_->recordFree(recorderStream_, pObject);
+        }
+        ++stats_.deallocations;
+        --stats_.allocations;
+
+        // keep it for the next allocate
+        Node* pNode = static_cast<Node*>(pObject);
+        pNode->pNext = pFreeList_;
+        pFreeList_ = pNode;
+    }
+    else if (config_.useCPPMemManager) {
+        // record the free before the block can be handed out again
+        if (pRecorder_ != nullptr) {
+            pRecorder_->recordFree(recorderStream_, pObject);
+        }
+
         // update stats assuming allocation successful
         ++stats_.deallocations;
         --stats_.allocations;
@@ -54,6 +112,30 @@ void SimpleAllocator::free(void* pObject) {
     }
 }
 
+unsigned SimpleAllocator::reset() {
+    if (!config_.isArena) {
+        return 0;
+    }
+    // every block still out counts as freed, the chunks are carved again
+    unsigned freed = stats_.allocations;
+    stats_.deallocations += freed;
+    stats_.allocations = 0;
+    pFreeList_ = nullptr;
+    chunk_ = 0;
+    carved_ = 0;
+    return freed;
+}
+
+unsigned SimpleAllocator::releaseAll() {
+    unsigned released = static_cast<unsigned>(chunks_.size());
+    reset();
+    for (char* pChunk : chunks_) {
+        delete[] pChunk;
+    }
+    chunks_.clear();
+    return released;
+}
+
 SimpleAllocatorConfig SimpleAllocator::getConfig() const { return config_; }
 
 SimpleAllocatorStats SimpleAllocator::getStats() const { return stats_; }
@@ -705,6 +705,27 @@ int main(int argc, char* argv[]) {
         //timeTaken = clock() - start;
         //cout << endl <<  "Time taken: " << timeTaken << "ms" << endl; 
         break;
+    case 11:
+        cout << "=== Test clear(ing) a BST in an arena allocator ===" << endl;
+        {
+            // nodes are carved out of chunks, and clear() leaves them there
+            SimpleAllocatorConfig config;
+            config.objectsPerPage = 64;
+            config.isArena = true;
+            allocator = new SimpleAllocator(sizeof(BST<int>::BinTreeNode), config);
+            BST<int> arenaBST(allocator);
+            addInts<int>(arenaBST, 100, false, true);
+            removeInts<int>(arenaBST, false, 10, true);
+            removeInts<int>(arenaBST, true);
+            cout << "blocks out: " << allocator->getStats().allocations
+                 << ", frees: " << allocator->getStats().deallocations << endl;
+            cout << "reset freed " << allocator->reset() << " blocks" << endl;
+            cout << endl;
+
+            // the tree is built again in the same chunks
+            addInts<int>(arenaBST, 8);
+        }
+        break;
     default:
         cout << "Please select a valid test." << endl;
         break;
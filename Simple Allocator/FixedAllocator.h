@@ -0,0 +1,465 @@
+/**
+ * @file FixedAllocator.h
+ * @brief FixedAllocator class template definition
+ *        A SimpleAllocator whose object size, page capacity, header type,
+ *        pad bytes and alignment are template parameters, so that the
+ *        whole block and page layout is constexpr: every offset folds into
+ *        the instructions that use it, and the branches for the other
+ *        header types are not compiled at all
+ * @date 16 Oct 2026
+ */
+
+#ifndef FIXEDALLOCATOR_H
+#define FIXEDALLOCATOR_H
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unordered_set>
+#include "SimpleAllocator.h"
+
+/**
+ * The FixedAllocator class template
+ * - pages, blocks, patterns, headers, statistics and exceptions are the
+ *   same as a single-threaded SimpleAllocator with the equivalent config
+ *   (see getConfig()), byte for byte up to the end of the last block:
+ *   blocks are carved lazily from the last one of the newest page down,
+ *   and freed blocks are reused first, last in first out
+ * - Checked is the compile-time counterpart of config.isChecked: without
+ *   it, there are no patterns, pad checks, headers or free() validation
+ * - checked pages keep their occupancy bitmap behind the last block, so
+ *   that free() finds bad boundaries and double frees with a mask, a
+ *   hash lookup and constant offsets
+ * - the runtime class's other features (concurrent mode, growing pages,
+ *   freeing empty pages, mmap, the quarantine, poisoning, tracing, dumps,
+ *   arenas and external headers, which need a MemBlockInfo pool and
+ *   interned labels) stay with SimpleAllocator
+ * @tparam ObjectSize object size
+ * @tparam ObjectsPerPage number of objects per page
+ * @tparam Header header type (not EXTERNAL_HEADER)
+ * @tparam PadBytes num bytes of padding on each side of a block
+ * @tparam Alignment the boundary to align the data of every block to
+ *         (a power of two, 0 for none)
+ * @tparam Checked false for the release fast path
+ * @tparam UserDefinedBytes additional user-defined bytes (EXTENDED_HEADER)
+ */
+template <size_t ObjectSize, unsigned ObjectsPerPage,
+          SimpleAllocatorConfig::HeaderType Header = SimpleAllocatorConfig::NO_HEADER,
+          unsigned PadBytes = 0, unsigned Alignment = 0, bool Checked = true,
+          size_t UserDefinedBytes = 0>
+class FixedAllocator {
+    static_assert(ObjectSize >= sizeof(Node), "a free block holds the free list link");
+    static_assert(ObjectsPerPage > 0, "a page holds at least one object");
+    static_assert(Alignment == 0 || (Alignment & (Alignment - 1)) == 0, "the alignment is a power of two");
+    static_assert(Header != SimpleAllocatorConfig::EXTERNAL_HEADER,
+                  "external headers need per-page state, use SimpleAllocator");
+
+    /**
+     * Smallest power of two that holds a page of the given size and is a
+     * multiple of the alignment
+     * @param pageBytes bytes used in the page
+     * @return the span
+     */
+    static constexpr size_t spanFor(size_t pageBytes)
+    {
+        size_t span = 1;
+        while (span < pageBytes || span < Alignment)
+        {
+            span <<= 1;
+        }
+        return span;
+    }
+
+public:
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+    static constexpr bool IS_CHECKED = false; // this build only has the release fast path
+#else
+    static constexpr bool IS_CHECKED = Checked;
+#endif
+
+    // Block geometry, the same as SimpleAllocator computes at runtime
+    static constexpr size_t HEADER_SIZE =
+        Header == SimpleAllocatorConfig::BASIC_HEADER ? sizeof(unsigned) + 1 :
+        Header == SimpleAllocatorConfig::EXTENDED_HEADER ? sizeof(unsigned int) + sizeof(unsigned short) + sizeof(char) + UserDefinedBytes : 0;
+    static constexpr size_t BLOCK_SIZE = ObjectSize + 2 * PadBytes + HEADER_SIZE; // header, pads and object
+    static constexpr size_t LEFT_ALIGN = Alignment > 1 ? (Alignment - (sizeof(void*) + HEADER_SIZE + PadBytes) % Alignment) % Alignment : 0; // alignment bytes after the page link
+    static constexpr size_t INTER_ALIGN = Alignment > 1 ? (Alignment - BLOCK_SIZE % Alignment) % Alignment : 0; // alignment bytes between blocks
+    static constexpr size_t STRIDE = BLOCK_SIZE + INTER_ALIGN; // distance from one block to the next
+    static constexpr size_t FIRST_BLOCK_OFFSET = sizeof(void*) + LEFT_ALIGN + HEADER_SIZE + PadBytes; // first block's data from the page start
+    static constexpr size_t BLOCKS_END = FIRST_BLOCK_OFFSET + (ObjectsPerPage - 1) * STRIDE + ObjectSize + PadBytes; // end of the last block's right pad
+
+    // Page geometry
+    static constexpr size_t BITMAP_WORDS = IS_CHECKED ? (ObjectsPerPage + 63) / 64 : 0; // occupancy words behind the last block
+    static constexpr size_t BITMAP_OFFSET = (BLOCKS_END + sizeof(unsigned long long) - 1) / sizeof(unsigned long long) * sizeof(unsigned long long);
+    static constexpr size_t PAGE_SPAN = spanFor(BITMAP_OFFSET + BITMAP_WORDS * sizeof(unsigned long long)); // pages are aligned to it
+    static_assert(BLOCKS_END == sizeof(void*) + LEFT_ALIGN + BLOCK_SIZE * ObjectsPerPage + INTER_ALIGN * (ObjectsPerPage - 1),
+                  "the page layout must match SimpleAllocator::pageSizeFor()");
+
+    /**
+     * Constructor
+     * - allocates the first page, as SimpleAllocator does
+     * @param maxPages maximum number of pages (UNLIMITED_PAGES for no limit)
+     * @param useCPPMemManager use C++ memory manager (operator new) instead of malloc
+     * @throws SimpleAllocatorException if construction fails
+     */
+    FixedAllocator(unsigned maxPages = DEFAULT_MAX_PAGES, bool useCPPMemManager = false)
+        : pFreeList_(nullptr), pPageList_(nullptr), bumpNext_(nullptr), bumpRemaining_(0),
+          maxPages_(maxPages), useCPPMemManager_(useCPPMemManager)
+    {
+        stats_.objectSize = ObjectSize;
+        stats_.blockSize = BLOCK_SIZE;
+        //reported with SimpleAllocator's historical padBytesSize * maxPages term,
+        //the page itself ends at BLOCKS_END
+        stats_.pageSize = BLOCKS_END + PadBytes * maxPages;
+        stats_.alignBytes = LEFT_ALIGN + INTER_ALIGN * (ObjectsPerPage - 1);
+        stats_.overheadBytes = BLOCKS_END - ObjectSize * ObjectsPerPage;
+        allocateNewPage();
+    }
+
+    /**
+     * Destructor
+     * (never throws)
+     */
+    ~FixedAllocator()
+    {
+        while (pPageList_ != nullptr)
+        {
+            char* page = reinterpret_cast<char*>(pPageList_);
+            pPageList_ = pPageList_->pNext;
+            releasePage(page);
+        }
+    }
+
+    /**
+     * Allocate memory
+     * @param pLabel label for memory block (only for EXTERNAL_HEADER, so unused)
+     * @return pointer to allocated memory
+     * @throws SimpleAllocatorException E_NO_PAGE, E_NO_MEMORY or
+     *         E_CORRUPTED_BLOCK (checked)
+     */
+    void* allocate(const char* pLabel = 0)
+    {
+        (void)pLabel;
+        if (pFreeList_ == nullptr && bumpRemaining_ == 0)
+        {
+            allocateNewPage();
+        }
+        if constexpr (IS_CHECKED)
+        {
+            corruptionCheck(pFreeList_ != nullptr ? reinterpret_cast<char*>(pFreeList_) : bumpNext_);
+        }
+        //recycled blocks first, then fresh ones off the newest page
+        Node* block = pFreeList_;
+        if (block != nullptr)
+        {
+            pFreeList_ = block->pNext;
+        }
+        else
+        {
+            block = reinterpret_cast<Node*>(bumpNext_);
+            bumpNext_ -= STRIDE;
+            bumpRemaining_--;
+        }
+
+        stats_.allocations++;
+        stats_.objectsInUse++;
+        stats_.freeObjects--;
+        if (stats_.objectsInUse > stats_.mostObjects)
+        {
+            stats_.mostObjects = stats_.objectsInUse;
+        }
+
+        if constexpr (IS_CHECKED)
+        {
+            char* data = reinterpret_cast<char*>(block);
+            unsigned index = 0;
+            unsigned long long* bitmap = bitmapOf(data, index);
+            bitmap[index / 64] |= 1ULL << (index % 64);
+            memset(data, SimpleAllocator::ALLOCATED_PATTERN, ObjectSize);
+            char* header = data - PadBytes - HEADER_SIZE;
+            if constexpr (Header == SimpleAllocatorConfig::EXTENDED_HEADER)
+            {
+                (*header)++;
+                unsigned short allocNum = static_cast<unsigned short>(stats_.allocations);
+                memcpy(header + 2, &allocNum, sizeof(allocNum));
+            }
+            else if constexpr (Header == SimpleAllocatorConfig::BASIC_HEADER)
+            {
+                *header = static_cast<char>(stats_.allocations);
+            }
+            if constexpr (Header != SimpleAllocatorConfig::NO_HEADER)
+            {
+                *(data - PadBytes - 1) = 0x01;
+            }
+        }
+        return block;
+    }
+
+    /**
+     * Free (deallocate) memory
+     * @param pObj pointer to object to deallocate
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY, or (checked)
+     *         E_MULTIPLE_FREE or E_CORRUPTED_BLOCK
+     */
+    void free(void* pObj)
+    {
+        if (pObj == nullptr)
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_BAD_BOUNDARY,
+                "Error during free: not on a block boundary in page."
+            );
+        }
+        char* data = static_cast<char*>(pObj);
+        if constexpr (IS_CHECKED)
+        {
+            //is the address on a block of one of our pages, and is the block allocated
+            char* page = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(data) & ~static_cast<uintptr_t>(PAGE_SPAN - 1));
+            size_t offset = static_cast<size_t>(data - page);
+            if (pages_.find(page) == pages_.end() || offset < FIRST_BLOCK_OFFSET
+                || (offset - FIRST_BLOCK_OFFSET) % STRIDE != 0 || (offset - FIRST_BLOCK_OFFSET) / STRIDE >= ObjectsPerPage)
+            {
+                throw SimpleAllocatorException(
+                    SimpleAllocatorException::E_BAD_BOUNDARY,
+                    "Error during free: not on a block boundary in page."
+                );
+            }
+            unsigned index = 0;
+            unsigned long long* bitmap = bitmapOf(data, index);
+            if ((bitmap[index / 64] & (1ULL << (index % 64))) == 0)
+            {
+                throw SimpleAllocatorException(
+                    SimpleAllocatorException::E_MULTIPLE_FREE,
+                    "Error during free: block has already been freed."
+                );
+            }
+            corruptionCheck(data);
+            memset(data, SimpleAllocator::FREED_PATTERN, ObjectSize);
+            char* header = data - PadBytes - HEADER_SIZE;
+            if constexpr (Header == SimpleAllocatorConfig::EXTENDED_HEADER)
+            {
+                unsigned short useCount = 0;
+                memcpy(header + 2, &useCount, sizeof(useCount));
+            }
+            else if constexpr (Header == SimpleAllocatorConfig::BASIC_HEADER)
+            {
+                *header = 0;
+            }
+            if constexpr (Header != SimpleAllocatorConfig::NO_HEADER)
+            {
+                *(data - PadBytes - 1) = 0;
+            }
+            bitmap[index / 64] &= ~(1ULL << (index % 64));
+        }
+        stats_.deallocations++;
+        stats_.objectsInUse--;
+        stats_.freeObjects++;
+        Node* block = reinterpret_cast<Node*>(data);
+        block->pNext = pFreeList_;
+        pFreeList_ = block;
+    }
+
+    /**
+     * Get the equivalent SimpleAllocator configuration
+     * @return configuration parameters
+     */
+    SimpleAllocatorConfig getConfig() const
+    {
+        SimpleAllocatorConfig config(useCPPMemManager_, ObjectsPerPage, maxPages_,
+                SimpleAllocatorConfig::HeaderBlockInfo(Header, 0, UserDefinedBytes), Alignment, PadBytes);
+        config.leftAlignBytesSize = static_cast<unsigned>(LEFT_ALIGN);
+        config.interAlignBytesSize = static_cast<unsigned>(INTER_ALIGN);
+        config.isChecked = IS_CHECKED;
+        return config;
+    }
+
+    /**
+     * Get the statistics struct
+     * @return statistics
+     */
+    SimpleAllocatorStats getStats() const
+    {
+        return stats_;
+    }
+
+    /**
+     * Get ptr to head of internal free list
+     * @return ptr to head of internal free list
+     */
+    const void* getFreeList() const
+    {
+        return pFreeList_;
+    }
+
+    /**
+     * Get ptr to head of internal page list
+     * @return ptr to head of internal page list
+     */
+    const void* getPageList() const
+    {
+        return pPageList_;
+    }
+
+private:
+    /**
+     * Allocate a new page, which becomes the page blocks are carved from
+     * (checked mode signs every block of it first)
+     */
+    void allocateNewPage()
+    {
+        if (maxPages_ != UNLIMITED_PAGES && stats_.pagesInUse >= maxPages_)
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_NO_PAGE,
+                "ERROR when allocating new page: maximum number of pages has been allocated."
+            );
+        }
+        char* page = nullptr;
+        if (useCPPMemManager_)
+        {
+            page = static_cast<char*>(operator new[](PAGE_SPAN, std::align_val_t(PAGE_SPAN), std::nothrow));
+        }
+        else
+        {
+            page = static_cast<char*>(std::aligned_alloc(PAGE_SPAN, PAGE_SPAN));
+        }
+        if (page == nullptr)
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_NO_MEMORY,
+                "Memory allocation for a new page failed."
+            );
+        }
+        if constexpr (IS_CHECKED)
+        {
+            try
+            {
+                pages_.insert(page);
+            }
+            catch (...)
+            {
+                releasePage(page);
+                throw;
+            }
+            signPage(page);
+        }
+        //link new page in the page list
+        Node* pageNode = reinterpret_cast<Node*>(page);
+        pageNode->pNext = pPageList_;
+        pPageList_ = pageNode;
+        //carve from the last block down
+        bumpNext_ = page + FIRST_BLOCK_OFFSET + (ObjectsPerPage - 1) * STRIDE;
+        bumpRemaining_ = ObjectsPerPage;
+        stats_.pagesInUse++;
+        stats_.pageBytes += BLOCKS_END;
+        stats_.freeObjects += ObjectsPerPage;
+    }
+
+    /**
+     * Give a page's memory back
+     * @param page the page
+     */
+    void releasePage(char* page)
+    {
+        if (useCPPMemManager_)
+        {
+            operator delete[](page, std::align_val_t(PAGE_SPAN));
+        }
+        else
+        {
+            std::free(page);
+        }
+    }
+
+    /**
+     * Sign the blocks of a new page: alignment bytes, pads, the
+     * unallocated pattern, cleared headers and an empty bitmap
+     * @param page the page
+     */
+    void signPage(char* page)
+    {
+        if constexpr (LEFT_ALIGN > 0)
+        {
+            memset(page + sizeof(void*), SimpleAllocator::ALIGN_PATTERN, LEFT_ALIGN);
+        }
+        char* data = page + FIRST_BLOCK_OFFSET;
+        for (unsigned i = 0; i < ObjectsPerPage; i++, data += STRIDE)
+        {
+            if constexpr (INTER_ALIGN > 0)
+            {
+                if (i + 1 < ObjectsPerPage)
+                {
+                    memset(data + ObjectSize + PadBytes, SimpleAllocator::ALIGN_PATTERN, INTER_ALIGN);
+                }
+            }
+            if constexpr (PadBytes > 0)
+            {
+                memset(data - PadBytes, SimpleAllocator::PAD_PATTERN, PadBytes);
+                memset(data + ObjectSize, SimpleAllocator::PAD_PATTERN, PadBytes);
+            }
+            memset(data, SimpleAllocator::UNALLOCATED_PATTERN, ObjectSize);
+            if constexpr (HEADER_SIZE > 0)
+            {
+                memset(data - PadBytes - HEADER_SIZE, 0, HEADER_SIZE);
+            }
+        }
+        memset(page + BITMAP_OFFSET, 0, BITMAP_WORDS * sizeof(unsigned long long));
+    }
+
+    /**
+     * Find the occupancy bitmap of a block's page, and its bit
+     * @param data the block
+     * @param index receives the block's index on the page
+     * @return the bitmap
+     */
+    static unsigned long long* bitmapOf(char* data, unsigned& index)
+    {
+        char* page = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(data) & ~static_cast<uintptr_t>(PAGE_SPAN - 1));
+        index = static_cast<unsigned>((data - page - FIRST_BLOCK_OFFSET) / STRIDE);
+        return reinterpret_cast<unsigned long long*>(page + BITMAP_OFFSET);
+    }
+
+    /**
+     * Check the pad bytes on both sides of a block
+     * @param data the block
+     * @throws SimpleAllocatorException E_CORRUPTED_BLOCK
+     */
+    static void corruptionCheck(const char* data)
+    {
+        for (unsigned i = 0; i < PadBytes; i++)
+        {
+            if (static_cast<unsigned char>((data - PadBytes)[i]) != SimpleAllocator::PAD_PATTERN)
+            {
+                throw SimpleAllocatorException(
+                    SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                    "ERROR when checking pad bytes: memory corrupted before block."
+                );
+            }
+        }
+        for (unsigned i = 0; i < PadBytes; i++)
+        {
+            if (static_cast<unsigned char>(data[ObjectSize + i]) != SimpleAllocator::PAD_PATTERN)
+            {
+                throw SimpleAllocatorException(
+                    SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                    "ERROR when checking pad bytes: memory corrupted after block."
+                );
+            }
+        }
+    }
+
+    SimpleAllocatorStats stats_; // Statistics
+    Node* pFreeList_; // Head of internal free list (freed blocks only)
+    Node* pPageList_; // Head of internal page list
+    char* bumpNext_; // next block to carve off the newest page
+    unsigned bumpRemaining_; // blocks of the newest page not carved yet
+    unsigned maxPages_; // Maximum number of pages (UNLIMITED_PAGES for no limit)
+    bool useCPPMemManager_; // Use C++ memory manager (operator new) instead of malloc
+    std::unordered_set<const char*> pages_; // every page, to tell ours from other memory (checked only)
+
+    // Disable copy constructor and assignment operator
+    FixedAllocator(const FixedAllocator&) = delete;
+    FixedAllocator& operator=(const FixedAllocator&) = delete;
+};
+
+#endif // FIXEDALLOCATOR_H
@@ -0,0 +1,211 @@
+/**
+ * @file ShardedAllocator.cpp
+ * @brief ShardedAllocator class definition
+ *        Serves each call from the SimpleAllocator shard of the CPU the
+ *        calling thread is on, and frees each block back to its own shard
+ * @date 16 Oct 2026
+ */
+#include <functional>
+#include <thread>
+#include "ShardedAllocator.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#define SHARDEDALLOCATOR_HAS_GETCPU
+#endif
+
+ShardedAllocator::ShardedAllocator(size_t objectSize, const SimpleAllocatorConfig& config, unsigned shards)
+    : shards_(nullptr), numShards_(shards), isChecked_(true)
+{
+    if (numShards_ == 0)
+    {
+        numShards_ = std::thread::hardware_concurrency();
+    }
+    if (numShards_ == 0)//the number of CPUs is not known
+    {
+        numShards_ = 1;
+    }
+
+    //every shard is single-threaded behind its own lock, and its pages
+    //are all of one size so that a block finds its shard with a mask
+    SimpleAllocatorConfig shardConfig = config;
+    shardConfig.isConcurrent = false;
+    shardConfig.isLockFree = false;
+    shardConfig.remoteFrees = false;
+    shardConfig.maxObjectsPerPage = 0;
+
+    shards_ = new Shard[numShards_];
+    unsigned created = 0;
+    try
+    {
+        for (; created < numShards_; created++)
+        {
+            shards_[created].pPool = new SimpleAllocator(objectSize, shardConfig);
+            shardOf_[shards_[created].pPool] = created;
+        }
+        isChecked_ = shards_[0].pPool->getConfig().isChecked;
+    }
+    catch (...)
+    {
+        //don't leak the shards made so far
+        while (created > 0)
+        {
+            delete shards_[--created].pPool;
+        }
+        delete[] shards_;
+        throw;
+    }
+}
+
+ShardedAllocator::~ShardedAllocator()
+{
+    for (unsigned i = 0; i < numShards_; i++)
+    {
+        delete shards_[i].pPool;
+    }
+    delete[] shards_;
+}
+
+std::unique_lock<std::mutex> ShardedAllocator::lockShard(Shard& shard)
+{
+    std::unique_lock<std::mutex> guard(shard.lock, std::try_to_lock);
+    if (!guard.owns_lock())
+    {
+        guard.lock();
+        shard.contended++;
+    }
+    return guard;
+}
+
+unsigned ShardedAllocator::currentShard() const
+{
+#ifdef SHARDEDALLOCATOR_HAS_GETCPU
+    int cpu = sched_getcpu();
+    if (cpu >= 0)
+    {
+        return static_cast<unsigned>(cpu) % numShards_;
+    }
+#endif
+    //no CPU number, spread the threads by their ids instead
+    thread_local size_t threadHash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return static_cast<unsigned>(threadHash % numShards_);
+}
+
+void* ShardedAllocator::allocate(const char* pLabel)
+{
+    Shard& shard = shards_[currentShard()];
+    std::unique_lock<std::mutex> guard = lockShard(shard);
+    return shard.pPool->allocate(pLabel);
+}
+
+void ShardedAllocator::free(void* pObj)
+{
+    if (pObj == nullptr)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    unsigned current = currentShard();
+    if (isChecked_)
+    {
+        //make sure the block is on a page of some shard before anything
+        //of its page is read, so that foreign memory (malloc, the stack,
+        //another layout) is reported instead of read; the calling thread's
+        //shard is the likely one, so it is asked first
+        for (unsigned i = 0; i < numShards_; i++)
+        {
+            unsigned s = (current + i) % numShards_;
+            Shard& shard = shards_[s];
+            std::unique_lock<std::mutex> guard = lockShard(shard);
+            if (shard.pPool->owns(pObj))
+            {
+                if (s != current)
+                {
+                    shard.crossFrees++;
+                }
+                shard.pPool->free(pObj);
+                return;
+            }
+        }
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    //unchecked, the block's page footer says which shard it belongs to
+    auto it = shardOf_.find(shards_[0].pPool->ownerOf(pObj));
+    if (it == shardOf_.end())
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    bool cross = it->second != current;
+    Shard& shard = shards_[it->second];
+    std::unique_lock<std::mutex> guard = lockShard(shard);
+    if (cross)
+    {
+        shard.crossFrees++;
+    }
+    shard.pPool->free(pObj);
+}
+
+unsigned ShardedAllocator::freeEmptyPages()
+{
+    unsigned released = 0;
+    for (unsigned i = 0; i < numShards_; i++)
+    {
+        std::lock_guard<std::mutex> guard(shards_[i].lock);
+        released += shards_[i].pPool->freeEmptyPages();
+    }
+    return released;
+}
+
+unsigned ShardedAllocator::numShards() const
+{
+    return numShards_;
+}
+
+const SimpleAllocator* ShardedAllocator::getShard(unsigned shard) const
+{
+    return shards_[shard].pPool;
+}
+
+ShardStats ShardedAllocator::getShardStats(unsigned shard) const
+{
+    ShardStats stats;
+    std::lock_guard<std::mutex> guard(shards_[shard].lock);
+    stats.pool = shards_[shard].pPool->getStats();
+    stats.contended = shards_[shard].contended;
+    stats.crossFrees = shards_[shard].crossFrees;
+    return stats;
+}
+
+SimpleAllocatorStats ShardedAllocator::getStats() const
+{
+    SimpleAllocatorStats stats;
+    for (unsigned i = 0; i < numShards_; i++)
+    {
+        SimpleAllocatorStats shardStats = getShardStats(i).pool;
+        //the layout is the same in every shard
+        stats.objectSize = shardStats.objectSize;
+        stats.blockSize = shardStats.blockSize;
+        stats.pageSize = shardStats.pageSize;
+        stats.alignBytes = shardStats.alignBytes;
+        stats.overheadBytes = shardStats.overheadBytes;
+        //the counts add up
+        stats.freeObjects += shardStats.freeObjects;
+        stats.objectsInUse += shardStats.objectsInUse;
+        stats.pagesInUse += shardStats.pagesInUse;
+        stats.mostObjects += shardStats.mostObjects;
+        stats.allocations += shardStats.allocations;
+        stats.deallocations += shardStats.deallocations;
+        stats.pagesFreed += shardStats.pagesFreed;
+        stats.quarantinedObjects += shardStats.quarantinedObjects;
+        stats.pageBytes += shardStats.pageBytes;
+    }
+    return stats;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file ShardedAllocator.h
+ * @brief ShardedAllocator class definition
+ *        A front end that owns one single-threaded SimpleAllocator per CPU
+ *        and serves each call from the shard of the CPU the calling thread
+ *        is running on, so that memory grows with the number of cores
+ *        rather than with the number of threads
+ * @date 16 Oct 2026
+ */
+
+#ifndef SHARDEDALLOCATOR_H
+#define SHARDEDALLOCATOR_H
+#include <mutex>
+#include <unordered_map>
+#include "SimpleAllocator.h"
+
+/**
+ * Statistics of one shard
+ */
+struct ShardStats
+{
+    /**
+     * Constructor
+     * - all params are initialized to 0
+     */
+    ShardStats() :
+        contended(0),
+        crossFrees(0) {}
+
+    SimpleAllocatorStats pool; // statistics of the shard's allocator
+    unsigned contended; // calls that found the shard's lock taken (a thread migrated, or was preempted holding it)
+    unsigned crossFrees; // blocks of the shard freed by a thread on another shard's CPU
+};
+
+/**
+ * The ShardedAllocator class
+ * - the shard of a call is the CPU number from sched_getcpu() (which
+ *   glibc 2.35 and later read from the thread's rseq area, without a
+ *   system call) modulo the number of shards; where there is no CPU
+ *   number, each thread sticks to a shard picked from its id
+ * - a thread may migrate between reading the CPU number and using the
+ *   shard, so each shard still has a lock; it is taken without waiting
+ *   unless another thread is in the same shard, which is counted
+ * - free() sends a block back to the shard it came from, whichever CPU
+ *   the freeing thread is on: checked shards look its page up in each
+ *   shard (the calling thread's first), unchecked ones read the footer of
+ *   its page (see SimpleAllocator::ownerOf)
+ * - no thread keeps blocks of its own, so hundreds of short-lived threads
+ *   cost no more memory than one thread per CPU
+ */
+class ShardedAllocator {
+public:
+    /**
+     * Constructor
+     * @param objectSize object size
+     * @param config configuration for every shard (config.isConcurrent,
+     *        config.isLockFree, config.remoteFrees and
+     *        config.maxObjectsPerPage are ignored: each shard is a
+     *        single-threaded allocator with pages of one size)
+     * @param shards number of shards (0 for one per CPU)
+     * @throws SimpleAllocatorException if construction fails
+     */
+    ShardedAllocator(size_t objectSize, const SimpleAllocatorConfig& config = SimpleAllocatorConfig(),
+            unsigned shards = 0);
+
+    /**
+     * Destructor
+     */
+    ~ShardedAllocator();
+
+    /**
+     * Allocate memory from the calling thread's shard
+     * @param pLabel label for memory block (only for EXTERNAL_HEADER)
+     * @return pointer to allocated memory
+     * @throws SimpleAllocatorException E_NO_PAGE or E_NO_MEMORY (the page
+     *         limit is per shard)
+     */
+    void* allocate(const char* pLabel = 0);
+
+    /**
+     * Free memory back to the shard it was allocated from
+     * @param pObj pointer to object to deallocate (unchecked, it must be a
+     *        block of this allocator: its page is read to find the shard)
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY if pObj is nullptr or
+     *         (checked) not on a page of this allocator, or whatever the
+     *         shard's free() throws
+     */
+    void free(void* pObj);
+
+    /**
+     * Free the empty pages of every shard
+     * @return number of pages released
+     */
+    unsigned freeEmptyPages();
+
+    /**
+     * Get the number of shards
+     * @return number of shards
+     */
+    unsigned numShards() const;
+
+    /**
+     * Get the shard of the calling thread right now
+     * @return index of the shard
+     */
+    unsigned currentShard() const;
+
+    /**
+     * Get the allocator of a shard (lock-free reads of it race with the
+     * shard's calls)
+     * @param shard index of the shard
+     * @return the shard's allocator
+     */
+    const SimpleAllocator* getShard(unsigned shard) const;
+
+    /**
+     * Get the statistics of one shard
+     * @param shard index of the shard
+     * @return statistics
+     */
+    ShardStats getShardStats(unsigned shard) const;
+
+    /**
+     * Get the statistics summed over every shard
+     * (mostObjects is the sum of each shard's peak, an upper bound)
+     * @return statistics
+     */
+    SimpleAllocatorStats getStats() const;
+
+private:
+    /**
+     * One shard, on a cache line of its own so that CPUs never share one
+     */
+    struct alignas(64) Shard
+    {
+        Shard() : pPool(nullptr), contended(0), crossFrees(0) {}
+
+        mutable std::mutex lock; // guards everything below
+        SimpleAllocator* pPool; // the shard's single-threaded allocator
+        unsigned contended; // see ShardStats
+        unsigned crossFrees; // see ShardStats
+    };
+
+    /**
+     * Lock a shard, counting it if the lock is taken
+     * @param shard the shard
+     * @return the held lock
+     */
+    static std::unique_lock<std::mutex> lockShard(Shard& shard);
+
+    Shard* shards_; // the shards
+    unsigned numShards_; // number of shards
+    bool isChecked_; // True if the shards are checked, so free() looks pages up before reading them
+    std::unordered_map<const SimpleAllocator*, unsigned> shardOf_; // shard of each allocator (never changes after construction)
+
+    // Make private to prevent copy construction and assignment
+    ShardedAllocator(const ShardedAllocator&) = delete;
+    ShardedAllocator& operator=(const ShardedAllocator&) = delete;
+};
+
+#endif // SHARDEDALLOCATOR_H
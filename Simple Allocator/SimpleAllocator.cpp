@@ -10,10 +10,331 @@
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include "SimpleAllocator.h"
+#include "SimpleTrace.h"
+#include "SimpleWorkload.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SIMPLEALLOCATOR_HAS_MMAP
+#endif
+
+// poisoning (config.poisonMemory) needs AddressSanitizer, or Valgrind's
+// client requests when built with -DSIMPLEALLOCATOR_VALGRIND
+#if defined(__SANITIZE_ADDRESS__)
+#define SIMPLEALLOCATOR_HAS_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SIMPLEALLOCATOR_HAS_ASAN
+#endif
+#endif
+#if defined(SIMPLEALLOCATOR_HAS_ASAN)
+#include <sanitizer/asan_interface.h>
+#define SIMPLEALLOCATOR_HAS_POISONING
+#elif defined(SIMPLEALLOCATOR_VALGRIND)
+#include <valgrind/memcheck.h>
+#define SIMPLEALLOCATOR_HAS_POISONING
+#endif
+
+/**
+ * A thread-local cache of free blocks for one concurrent allocator
+ * - pHead/count are only ever touched by the owning thread
+ * - the counters are atomics only so that getStats() may read them from 
+ *   another thread; the owner updates them with plain loads and stores
+ */
+struct SimpleAllocator::Magazine
+{
+    Magazine(SimpleAllocator* owner) : pHead(nullptr), count(0), allocations(0), deallocations(0), pOwner(owner), pRemote(nullptr) {}
+
+    Node* pHead; // head of the cached free blocks
+    std::atomic<unsigned> count; // number of cached free blocks
+    std::atomic<unsigned> allocations; // allocations made by the owning thread
+    std::atomic<unsigned> deallocations; // deallocations made by the owning thread
+    std::atomic<SimpleAllocator*> pOwner; // set to nullptr when the allocator is destroyed first
+    RemoteQueue* pRemote; // the thread's remote-free queue (config.remoteFrees, nullptr otherwise)
+};
+
+/**
+ * Blocks freed by other threads on the pages of one thread (config.remoteFrees)
+ * - any thread pushes, only the owning thread (or a thread holding the
+ *   allocator's lock once the queue is untaken) takes, and it always takes
+ *   the whole chain in one exchange, so the pushes need no ABA tag
+ * - count goes up before a block is linked and down after the chain is
+ *   taken, so it may be ahead of the chain for a moment but never behind
+ */
+struct SimpleAllocator::RemoteQueue
+{
+    RemoteQueue() : pHead(nullptr), count(0), taken(true) {}
+
+    /**
+     * Push a block freed by another thread
+     * @param block the block
+     */
+    void push(Node* block)
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+        Node* head = pHead.load(std::memory_order_relaxed);
+        do
+        {
+            block->pNext = head;
+        } while (!pHead.compare_exchange_weak(head, block, 
+                    std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Take every block on the queue
+     * @param last receives the last block of the chain
+     * @param blocks receives the number of blocks
+     * @return the first block of the chain, or nullptr if the queue is empty
+     */
+    Node* takeAll(Node*& last, unsigned& blocks)
+    {
+        blocks = 0;
+        Node* first = pHead.exchange(nullptr, std::memory_order_acquire);
+        for (last = first; last != nullptr; last = last->pNext)
+        {
+            blocks++;
+            if (last->pNext == nullptr)
+            {
+                break;
+            }
+        }
+        count.fetch_sub(blocks, std::memory_order_relaxed);
+        return first;
+    }
+
+    std::atomic<Node*> pHead; // last block pushed
+    std::atomic<unsigned> count; // blocks on the queue (for getStats())
+    std::atomic<bool> taken; // false once the owning thread has exited
+};
+
+namespace
+{
+    // guards every allocator's magazines_ and the pOwner of every magazine,
+    // so that an exiting thread and a dying allocator never race each other
+    // (only taken when a thread first uses an allocator, exits, or reads stats)
+    std::mutex registryLock;
+
+    // poisoned data is aligned to AddressSanitizer's shadow granule, so that
+    // neighbouring blocks never share one (threads poison their own blocks
+    // without racing on the shadow) and a block's data is poisoned exactly
+    const unsigned POISON_GRANULE = 8;
+
+    // index of the lowest set bit of a non-zero word
+    inline unsigned lowestBit(unsigned long long word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+        unsigned bit = 0;
+        while ((word & 1) == 0)
+        {
+            word >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    // number of set bits in a word
+    inline unsigned bitCount(unsigned long long word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+        unsigned count = 0;
+        for (; word != 0; word &= word - 1)
+        {
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    // make bytes unaddressable (config.poisonMemory)
+    inline void poisonBytes(const void* address, size_t size)
+    {
+#if defined(SIMPLEALLOCATOR_HAS_ASAN)
+        ASAN_POISON_MEMORY_REGION(address, size);
+#elif defined(SIMPLEALLOCATOR_HAS_POISONING)
+        VALGRIND_MAKE_MEM_NOACCESS(address, size);
+#else
+        (void)address;
+        (void)size;
+#endif
+    }
+
+    // make bytes addressable again, their contents undefined
+    inline void unpoisonBytes(const void* address, size_t size)
+    {
+#if defined(SIMPLEALLOCATOR_HAS_ASAN)
+        ASAN_UNPOISON_MEMORY_REGION(address, size);
+#elif defined(SIMPLEALLOCATOR_HAS_POISONING)
+        VALGRIND_MAKE_MEM_UNDEFINED(address, size);
+#else
+        (void)address;
+        (void)size;
+#endif
+    }
+
+    // source of SimpleAllocator::id_
+    std::atomic<unsigned long long> nextAllocatorId(1);
+
+    // the label the calling thread interned last, with the id of the
+    // allocator that holds it (0 for none yet)
+    struct InternedLabel
+    {
+        unsigned long long allocatorId;
+        const char* pLabel;
+    };
+    thread_local InternedLabel lastInterned = {0, nullptr};
+
+    // in lock-free mode the head of the shared free list is a pointer with
+    // a version tag in its unused upper bits; every push and pop bumps the
+    // tag, so a head that was popped and pushed back in the meantime (ABA)
+    // no longer compares equal
+    const unsigned TAG_SHIFT = sizeof(void*) == 8 ? 48 : 32;
+    const unsigned long long PTR_MASK = (1ULL << TAG_SHIFT) - 1;
+
+    inline Node* headPtr(unsigned long long head)
+    {
+        return reinterpret_cast<Node*>(static_cast<uintptr_t>(head & PTR_MASK));
+    }
+
+    inline unsigned long long nextHead(Node* ptr, unsigned long long oldHead)
+    {
+        return (((oldHead >> TAG_SHIFT) + 1) << TAG_SHIFT) | reinterpret_cast<uintptr_t>(ptr);
+    }
+
+    // pages from mmap are carved out of regions of this size (a huge page)
+    const size_t MMAP_REGION_SIZE = 2 * 1024 * 1024;
+
+    // single-writer increment of a counter that other threads may read
+    inline void bump(std::atomic<unsigned>& counter, unsigned by = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    // set once the calling thread's ThreadCache has been destroyed
+    // (a plain bool, so it stays readable after thread-local teardown)
+    thread_local bool threadCacheGone = false;
+}
+
+/**
+ * The magazines a thread has created, one per concurrent allocator it used
+ * - when the thread exits, its cached blocks go back to their allocators
+ */
+struct SimpleAllocator::ThreadCache
+{
+    ThreadCache() : lastId(0), pLast(nullptr) {}
+
+    ~ThreadCache()
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        for (auto& entry : entries)
+        {
+            Magazine* magazine = entry.second;
+            SimpleAllocator* owner = magazine->pOwner.load();
+            if (owner != nullptr)//allocator still alive, hand the blocks and counters back
+            {
+                owner->retireMagazine(magazine);
+                for (size_t i = 0; i < owner->magazines_.size(); i++)
+                {
+                    if (owner->magazines_[i] == magazine)
+                    {
+                        owner->magazines_.erase(owner->magazines_.begin() + i);
+                        break;
+                    }
+                }
+            }
+            delete magazine;
+        }
+        //allocators used from here on (by static destructors) must not come back
+        threadCacheGone = true;
+    }
+
+    unsigned long long lastId; // id of the allocator used last (fast path)
+    Magazine* pLast; // magazine of the allocator used last
+    std::vector<std::pair<unsigned long long, Magazine*>> entries; // all magazines of this thread
+};
+
+thread_local SimpleAllocator::ThreadCache SimpleAllocator::threadCache_;
+
+struct SimpleAllocator::MagazineScope
+{
+    MagazineScope(SimpleAllocator* allocator) 
+        : pAllocator(allocator), pMagazine(allocator->localMagazine()), pOneOff(nullptr)
+    {
+        if (pMagazine == nullptr)
+        {
+            pOneOff = new Magazine(allocator);
+            pMagazine = pOneOff;
+        }
+    }
+
+    ~MagazineScope()
+    {
+        if (pOneOff != nullptr)
+        {
+            pAllocator->retireMagazine(pOneOff);
+            delete pOneOff;
+        }
+    }
+
+    SimpleAllocator* pAllocator; // the allocator being used
+    Magazine* pMagazine; // the magazine to use for the call
+    Magazine* pOneOff; // owned one-off magazine, handed back at the end of the call
+};
+
+/**
+ * Bookkeeping for one page, so that it can be released once it is empty
+ * - the free list itself is singly linked through the blocks, so the
+ *   predecessor of every block of the page is kept here instead; that lets
+ *   the page's blocks be unlinked without walking the whole free list
+ */
+struct SimpleAllocator::PageInfo
+{
+    PageInfo(SimpleAllocator* allocator, char* page, char* firstBlock, unsigned objectsPerPage, size_t pageSpan) 
+        : pAllocator(allocator), pPage(page), pFirstBlock(firstBlock), objects(objectsPerPage), span(pageSpan), liveObjects(0), 
+          pPrevPage(nullptr), prevFree(objectsPerPage, nullptr), occupancy((objectsPerPage + 63) / 64, 0), pOwner(nullptr),
+          pLocalFree(nullptr), localFree(0), pPrevPartial(nullptr), pNextPartial(nullptr) {}
+
+    SimpleAllocator* pAllocator; // the allocator the page belongs to
+
+    char* pPage; // start of the page
+    char* pFirstBlock; // first block on the page
+    unsigned objects; // number of blocks on the page
+    size_t span; // span of the page (the page is aligned to it)
+    unsigned liveObjects; // blocks of this page that are not on the free list
+    Node* pPrevPage; // previous page in the page list (the page list itself is singly linked)
+    std::vector<Node*> prevFree; // previous block on the free list, for each block of this page
+    std::vector<unsigned long long> occupancy; // one bit per block, set while allocated (single-threaded mode)
+    RemoteQueue* pOwner; // remote-free queue of the thread whose refill made the page (config.remoteFrees)
+    Node* pLocalFree; // free blocks of this page, unless it is the current page (config.pageLocalFrees)
+    unsigned localFree; // blocks on pLocalFree
+    PageInfo* pPrevPartial; // neighbours on the partialPages_ list for liveObjects
+    PageInfo* pNextPartial;
+};
 
 void SimpleAllocator::corruptionCheck(Node* blockStart)
 {
+    //poisoned pads report an overrun when it happens, nothing to check here
+    if (config_.poisonMemory)
+    {
+        return;
+    }
     //start of block
     unsigned char* corruptCheck = reinterpret_cast<unsigned char*>(blockStart);
     // Checking corruption before the block
@@ -50,13 +371,22 @@ void SimpleAllocator::corruptionCheck(Node* blockStart)
 }
 
 
-SimpleAllocator::SimpleAllocator(size_t objectSize, const SimpleAllocatorConfig& config) : config_(config) 
+SimpleAllocator::SimpleAllocator(size_t objectSize, const SimpleAllocatorConfig& config) : config_(config),
+    id_(nextAllocatorId++), retiredAllocations_(0), retiredDeallocations_(0), allocNum_(0),
+    freeHead_(0), sharedFreeObjects_(0), pTrace_(nullptr), pRecorder_(nullptr), recorderStream_(0),
+    sweepPage_(nullptr), sweepIndex_(0), sweeperStop_(false)
 {
 // Initialize statistics
-stats_.objectSize = objectSize;
-stats_.blockSize = objectSize + (config.padBytesSize *2) + config.headerBlockInfo.size;
-//8 represents the size of the pointer to the next page
-stats_.pageSize = 8 + config.leftAlignBytesSize + (stats_.blockSize * config.objectsPerPage) + (config.interAlignBytesSize*(config.objectsPerPage-1)) + (config_.padBytesSize*config_.maxPages);//+ config.headerBlockInfo.size+ config.padBytesSize;//might need to add header and pad again
+// a free block holds the free list link, so smaller objects get room for it
+stats_.objectSize = objectSize < sizeof(Node) ? sizeof(Node) : objectSize;
+stats_.blockSize = layoutBlocks(objectSize, config_);
+blockStride_ = stats_.blockSize + config_.interAlignBytesSize;
+firstBlockOffset_ = sizeof(void*) + config_.leftAlignBytesSize + config_.headerBlockInfo.size + config_.padBytesSize;
+// the reported page size keeps its historical padBytesSize * maxPages term,
+// the pages themselves (span, pageBytes) are sized by pageSizeFor() alone
+stats_.pageSize = pageSizeFor(config.objectsPerPage) + config_.padBytesSize * config_.maxPages;
+stats_.alignBytes = config_.leftAlignBytesSize + config_.interAlignBytesSize * (config.objectsPerPage - 1);
+stats_.overheadBytes = pageSizeFor(config.objectsPerPage) - stats_.objectSize * config.objectsPerPage;
 //initalize all to 0
 stats_.allocations = 0;
 stats_.deallocations = 0;
@@ -65,329 +395,2395 @@ stats_.pagesInUse = 0;
 stats_.freeObjects = 0;
 stats_.mostObjects = 0;
 
+// the lock-free list only exists in concurrent mode
+config_.isLockFree = config_.isLockFree && config_.isConcurrent;
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+// this build only has the release fast path
+config_.isChecked = false;
+#endif
+// pages are tracked unless the shared list is lock-free
+trackPages_ = !config_.isLockFree;
+// pages only grow when they are tracked (and a ceiling above the first page is given)
+if (!trackPages_ || config_.maxObjectsPerPage < config_.objectsPerPage)
+{
+    config_.maxObjectsPerPage = config_.objectsPerPage;
+}
+// a free on another thread finds its page's owner through the page footer,
+// without the lock; that takes tracked pages that all have the same span
+config_.remoteFrees = config_.remoteFrees && config_.isConcurrent && trackPages_ 
+                      && config_.maxObjectsPerPage == config_.objectsPerPage;
+// a page can only keep its own free blocks when it is tracked
+config_.pageLocalFrees = config_.pageLocalFrees && trackPages_;
+pCurrentPage_ = nullptr;
+fullestPartial_ = 0;
+if (config_.pageLocalFrees)
+{
+    partialPages_.assign(config_.maxObjectsPerPage + 1, nullptr);
+}
+// pages are allocated at a power of two alignment with room for a footer
+pageSpan_ = spanFor(pageSizeFor(config_.objectsPerPage));
+maxSpan_ = spanFor(pageSizeFor(config_.maxObjectsPerPage));
+nextPageObjects_ = config_.objectsPerPage;
+pageObjects_ = 0;
+stats_.pageBytes = 0;
+#ifndef SIMPLEALLOCATOR_HAS_MMAP
+// no mmap on this platform, stay with new or malloc
+config_.useMmap = false;
+#endif
+// a region holds a whole number of pages
+regionSize_ = maxSpan_ > MMAP_REGION_SIZE ? maxSpan_ : MMAP_REGION_SIZE;
+regionCursor_ = nullptr;
+regionEnd_ = nullptr;
+bumpNext_ = nullptr;
+bumpRemaining_ = 0;
+emptyPages_ = 0;
+stats_.pagesFreed = 0;
+
 // Initialize free and page lists
 pFreeList_ = nullptr;
 pPageList_ = nullptr;
+// the quarantine is one FIFO, which threads would have to lock on every free;
+// its ring is made once, the blocks themselves hold nothing for it
+quarantineOldest_ = 0;
+if (config_.isConcurrent || config_.quarantineBytes < stats_.objectSize)
+{
+    config_.quarantineBytes = 0;
+}
+else
+{
+    quarantine_.resize(config_.quarantineBytes / stats_.objectSize);
+}
+// dropping every block at once is only safe with no thread holding any
+config_.isArena = config_.isArena && !config_.isConcurrent;
+
+// the trace is there from the first page on
+if (config_.traceEvents > 0)
+{
+    pTrace_ = new SimpleTrace(config_.traceEvents, stats_.objectSize, blockStride_, firstBlockOffset_, config_.isConcurrent);
+}
 
 // Allocate the first page
-allocateNewPage();
+try
+{
+    allocateNewPage();
+}
+catch (...)
+{
+    delete pTrace_;
+    throw;
+}
+
+// record the run if the environment asks for it
+setRecorder(SimpleWorkloadRecorder::fromEnvironment());
 }
 
 SimpleAllocator::~SimpleAllocator() 
 {
-    // Release all allocated pages
+    // The sweeper walks the pages, stop it before they go
+    stopSweeper();
+
+    // Orphan the magazines of threads that are still alive,
+    // they will be deleted by their threads (their blocks die with the pages)
+    if (config_.isConcurrent)
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        for (Magazine* magazine : magazines_)
+        {
+            magazine->pOwner.store(nullptr);
+        }
+        magazines_.clear();
+    }
+    // the blocks still queued die with the pages
+    for (RemoteQueue* queue : remoteQueues_)
+    {
+        delete queue;
+    }
 
+    // Release all allocated pages
     while (pPageList_ != nullptr) //for each page
     {   
-        if (config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)//if external header
-        {
-            //find start of page
-            char* startPage = reinterpret_cast<char*>(pPageList_);
-            size_t incr = config_.interAlignBytesSize+config_.headerBlockInfo.size+config_.padBytesSize + sizeof(char*);//find the increment from the start of the page
-            char* currentBlock = startPage + incr;//find the position of the first block
-            //loop every object on the page
-            for(unsigned int i = 0; i < config_.objectsPerPage; i++) 
-            {
-                //find the header location
-                char* header = reinterpret_cast<char*>(currentBlock) - config_.padBytesSize - config_.headerBlockInfo.size;
-                //find the info location
-                MemBlockInfo** temp = reinterpret_cast<MemBlockInfo**>(header);
-                MemBlockInfo* info = *temp;
-                //check if the MemBlockInfo still exists for that block
-                if(info!=nullptr)//for the blocks that have not been unallocated, the label needs to be dreed
-                {
-                    if (config_.useCPPMemManager) //delete the label
-                    {
-                        delete info->pLabel;
-                        delete info;                         
-                    } 
-                    else//free the label
-                    {
-                        std::free(info->pLabel);
-                        std::free(info);
-                    }
-                
-                }
-                //Move to the next block in the free list
-                currentBlock+=stats_.blockSize;
-            }
-        }
         // store the next page in the page list
         Node* currentPageNode = pPageList_;
         pPageList_ = pPageList_->pNext;
-
-        //delete or free the current page
+        if (config_.useMmap)//the regions go in one go below
+        {
+            freeExternalHeaders(reinterpret_cast<char*>(currentPageNode));
+        }
+        else
+        {
+            char* page = reinterpret_cast<char*>(currentPageNode);
+            freePage(page, trackPages_ ? pageInfos_[page]->span : pageSpan_);
+        }
+    }
+    unmapRegions();
+    for (auto& entry : pageInfos_)
+    {
+        delete entry.second;
+    }
+    // Release the interned labels
+    for (const std::string_view& label : labels_)
+    {
         if (config_.useCPPMemManager)
         {
-            delete[] reinterpret_cast<char*>(currentPageNode);
-        } else 
+            delete[] label.data();
+        } else
         {
-            std::free(reinterpret_cast<char*>(currentPageNode));
+            std::free(const_cast<char*>(label.data()));
         }
     }
+    delete pTrace_;
 }
 
-
-
-void* SimpleAllocator::allocate(const char* pLabel) 
+void SimpleAllocator::freePage(char* startPage, size_t span)
 {
-    // Check if there are any free blocks available
-    if (pFreeList_ == nullptr) 
-    {
-        // Allocate a new page if there are no free blocks
-        allocateNewPage();
-    }
-   
-  // Remove a block from the free list
-    Node* allocatedBlock = pFreeList_;
-    //check for corruption
-    corruptionCheck(allocatedBlock);
-    //link freelist to the next block
-    pFreeList_ = pFreeList_->pNext;
-
-    // Update allocation statistics
-    stats_.allocations++;
-    stats_.objectsInUse++;
-    stats_.freeObjects--;
-    char* header = reinterpret_cast<char*>(allocatedBlock) - config_.padBytesSize - config_.headerBlockInfo.size;
-    // Assuming 'allocatedBlock' points to the start of the memory block
-    unsigned char* blockPtr = reinterpret_cast<unsigned char*>(allocatedBlock);
-    // find the first instance of the PATTERN
-    unsigned char value = blockPtr[8];
+    freeExternalHeaders(startPage);
+    releasePageMemory(startPage, span);
+}
 
-    // set block to allocated pattern   
-    memset(allocatedBlock, ALLOCATED_PATTERN, stats_.objectSize);
-    // extended header, with mem layout:
-    // | user-defined | use count        | alloc num      | flag   |
-    // | char *       | unsigned short * | unsigned int * | bool * |
-    if(config_.headerBlockInfo.type == config_.EXTENDED_HEADER)
-    {  
-        (*header)++;//increment header with each allocation
-        unsigned short* useCount = reinterpret_cast<unsigned short*>(header + 2); 
-        *useCount =stats_.allocations;//total no of allocations
-    }
-    // external header, with mem layout:
-    // | MemBlockInfo*  | (it stores a pointer to a MemBlockInfo struct)
-    // | MemBlockInfo** | (so the header ptr is a pointer to a pointer)
-    else if(config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+void SimpleAllocator::freeExternalHeaders(char* startPage)
+{
+    if (config_.headerBlockInfo.type == config_.EXTERNAL_HEADER && config_.isChecked)//if external header (unchecked never fills them in)
     {
-        // Use new or malloc to allocate a new page of memory
-        //use char* for byte level memory control
-        MemBlockInfo* info = nullptr;
-        MemBlockInfo** temp = reinterpret_cast<MemBlockInfo**>(header);
-        if (value == UNALLOCATED_PATTERN)//only new for the first allocation of the block
+        //the first block's header points at the start of the page's pool
+        //(the labels are interned, they go with the allocator)
+        char* header = startPage + firstBlockOffset_ - config_.padBytesSize - config_.headerBlockInfo.size;
+        MemBlockInfo* infos = *reinterpret_cast<MemBlockInfo**>(header);
+        if (config_.useCPPMemManager) //delete the pool
         {
-            //only new for the first time
-            if (config_.useCPPMemManager) //if true use new
-            {
-                info = new MemBlockInfo;//makes a new page using char* and the size of the page(how many bytes)
-            } else //if false use malloc
-            {
-                info = static_cast<MemBlockInfo*>(malloc(sizeof(MemBlockInfo)));
-            }
-            
-            *temp = info; //store the pointer to the new location
+            delete[] infos;
         } 
-        else 
-        {
-            info = *temp;//if not the first time, get the info from the header
-        }
-         info->inUse = true;//store inUse value
-         info->allocNum = stats_.allocations;//store number of allocations
-         //info->pLabel = pLabel?strdup(pLabel):nullptr; //copy the label and store
-         if (config_.useCPPMemManager) //if true use new
-        {
-            info->pLabel = new char[strlen(pLabel) + 1];;//makes a new label
-        } else //if false use malloc
+        else//free the pool
         {
-            info->pLabel = static_cast<char*>(malloc(strlen(pLabel) + 1));//makes a new label
+            std::free(infos);
         }
-         
-         std::strcpy(info->pLabel, pLabel);//stores the label
-
-        return reinterpret_cast<Node*>(allocatedBlock); //return immediately if external header
-    }
-    //for all other cases
-    else
-    {
-        //store allocation value at the header
-        *header = stats_.allocations;
     }
-    //select flag location
-    char* flag = reinterpret_cast<char*>(allocatedBlock) -config_.padBytesSize - 1;
-    // Set the flag to 0x01
-    *flag = 0x01;
-    // Return a pointer to the allocated block (you might need to do some pointer arithmetic)
-    return reinterpret_cast<Node*>(allocatedBlock);
 }
 
-
-void SimpleAllocator::free(void* pObj) 
+const char* SimpleAllocator::internLabel(const char* pLabel)
 {
-    //exception handling
-    if (pObj == nullptr) {
-        // Do nothing if pObj is nullptr
-        throw SimpleAllocatorException(
-            SimpleAllocatorException::E_BAD_BOUNDARY,
-            "Error during free: not on a block boundary in page."
-        );
-    }
-    //exception handling
-    if(stats_.objectsInUse==0)
+    if (pLabel == nullptr)
     {
-        throw SimpleAllocatorException(
-            SimpleAllocatorException::E_BAD_BOUNDARY,
-            "Error during free: not on a block boundary in page."
-        );
+        return nullptr;
     }
-    
-    //check for corruption
-    corruptionCheck(reinterpret_cast<Node*>(pObj));
-    //find the start of the block
-    char* blockStart = reinterpret_cast<char*>(pObj);
-    //set the pattern for the block
-    memset(blockStart, FREED_PATTERN, stats_.objectSize);
-    //link the block to the free list
-    Node* freeBlock = reinterpret_cast<Node*>(blockStart);
-    freeBlock->pNext = pFreeList_;
-    pFreeList_ = freeBlock;
-    //set flag back to nullptr
-    char* flag = nullptr;
-    //depending on pad size, set the flag location
-    if(config_.padBytesSize>0)//if padding exists
+    //clients tend to use the same label over and over, and an interned
+    //label never changes, so the thread's last one needs no lock
+    if (lastInterned.allocatorId == id_ && std::strcmp(lastInterned.pLabel, pLabel) == 0)
     {
-        flag = reinterpret_cast<char*>(pObj) - 1 - config_.padBytesSize;
+        return lastInterned.pLabel;
     }
-    else//no padding
+    std::unique_lock<std::mutex> guard(labelLock_, std::defer_lock);
+    if (config_.isConcurrent)
     {
-        flag = reinterpret_cast<char*>(pObj) - 1;
-    }
-    //store stats
-    stats_.deallocations++;
-    stats_.objectsInUse--;
-    stats_.freeObjects++;
-    //find header location
-    char* header = reinterpret_cast<char*>(freeBlock) - config_.padBytesSize - config_.headerBlockInfo.size; 
-    // extended header, with mem layout:
-    // | user-defined | use count        | alloc num      | flag   |
-    // | char *       | unsigned short * | unsigned int * | bool * |
-    if(config_.headerBlockInfo.type == config_.EXTENDED_HEADER)
-    {  
-        //set all to 0
-        unsigned short* useCount = reinterpret_cast<unsigned short*>(header + 2); 
-        *useCount = 0;
-        *flag = 00;
-
+        guard.lock();
     }
-    // external header, with mem layout:
-    // | MemBlockInfo*  | (it stores a pointer to a MemBlockInfo struct)
-    // | MemBlockInfo** | (so the header ptr is a pointer to a pointer)
-    else if(config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+    auto it = labels_.find(std::string_view(pLabel));
+    if (it == labels_.end())
     {
-        MemBlockInfo** temp = reinterpret_cast<MemBlockInfo**>(header); //find location of double pointer
-        MemBlockInfo* info = *temp;//get the info from the double pouinter
-        info->inUse = false;//store to false
-        //based of specified memory management, delete or free the label
+        //first time this label is seen, store a copy for good
+        size_t length = std::strlen(pLabel);
+        char* copy = nullptr;
         if (config_.useCPPMemManager) //if true use new
         {
-            delete info->pLabel;//delete the label for every tune free
+            copy = new char[length + 1];
         } else //if false use malloc
         {
-           std::free(info->pLabel);//delete the label for every tune free
+            copy = static_cast<char*>(malloc(length + 1));
         }
-        info->pLabel = nullptr;//store to null
-        //delete info->pLabel;//delete the label
-        
+        std::memcpy(copy, pLabel, length + 1);
+        it = labels_.insert(std::string_view(copy, length)).first;
     }
-    //for all else
-    else
-    {
-        //set to 0s
-        *header  = 00;
-        *flag = 00;
-    }   
+    lastInterned.allocatorId = id_;
+    lastInterned.pLabel = it->data();
+    return lastInterned.pLabel;
 }
 
-void SimpleAllocator::allocateNewPage() 
+size_t SimpleAllocator::layoutBlocks(size_t objectSize, SimpleAllocatorConfig& config)
 {
-    // Check if the maximum number of pages has been reached
-    //exception handling
-    if (stats_.pagesInUse >= config_.maxPages) 
+    size_t blockSize = (objectSize < sizeof(Node) ? sizeof(Node) : objectSize) + (config.padBytesSize *2) + config.headerBlockInfo.size;
+    // poisoning replaces the patterns of checked mode, where the build can do it
+#if !defined(SIMPLEALLOCATOR_HAS_POISONING) || defined(SIMPLEALLOCATOR_UNCHECKED)
+    config.poisonMemory = false;
+#elif !defined(SIMPLEALLOCATOR_HAS_ASAN)
+    // the client requests are no-ops unless the program runs under Valgrind
+    config.poisonMemory = config.poisonMemory && RUNNING_ON_VALGRIND;
+#endif
+    config.poisonMemory = config.poisonMemory && config.isChecked;
+    if (config.poisonMemory && config.alignmentBoundary < POISON_GRANULE)
     {
-        throw SimpleAllocatorException(
-            SimpleAllocatorException::E_NO_PAGE,
-            "ERROR when allocating new page: maximum number of pages has been allocated."
-        );
+        config.alignmentBoundary = POISON_GRANULE;
     }
-
-    // Use new or malloc to allocate a new page of memory
-    //use char* for byte level memory control
-    char* newPage = nullptr;
-    if (config_.useCPPMemManager) //if true use new
-    {
-        newPage = new char[stats_.pageSize];//makes a new page using char* and the size of the page(how many bytes)
-    } else //if false use malloc
+    // alignment bytes, so that the data of every block lands on the boundary:
+    // leftAlign after the next page pointer, interAlign between blocks
+    config.leftAlignBytesSize = 0;
+    config.interAlignBytesSize = 0;
+    if (config.alignmentBoundary > 1)
     {
-        newPage = static_cast<char*>(malloc(stats_.pageSize));
+        size_t boundary = config.alignmentBoundary;
+        size_t lead = sizeof(void*) + config.headerBlockInfo.size + config.padBytesSize; //bytes in front of the first block
+        config.leftAlignBytesSize = static_cast<unsigned>((boundary - lead % boundary) % boundary);
+        config.interAlignBytesSize = static_cast<unsigned>((boundary - blockSize % boundary) % boundary);
+        //a header stays addressable, and so do the bytes in front of it in its
+        //shadow granule: make sure those are alignment bytes, not the right pad
+        //of the block before
+        if (config.poisonMemory && config.headerBlockInfo.size > 0)
+        {
+            size_t exposed = (POISON_GRANULE - (config.headerBlockInfo.size + config.padBytesSize) % POISON_GRANULE) % POISON_GRANULE;
+            if (config.interAlignBytesSize < exposed)
+            {
+                config.interAlignBytesSize += config.alignmentBoundary;
+            }
+        }
     }
+    return blockSize;
+}
 
-    // Check if memory allocation failed
-    //exception handling
-    if (newPage == nullptr) 
-    {
+unsigned SimpleAllocator::objectsPerSpan(size_t objectSize, const SimpleAllocatorConfig& config, size_t span)
+{
+    SimpleAllocatorConfig layout = config;
+    size_t blockSize = layoutBlocks(objectSize, layout);
+    //the page link, the leading alignment and the footer, then a block and
+    //its alignment gap per object, as pageSizeFor() and spanFor() count them
+    //(the last block has no gap after it)
+    size_t fixed = sizeof(void*) + layout.leftAlignBytesSize + sizeof(PageInfo*);
+    size_t stride = blockSize + layout.interAlignBytesSize;
+    size_t objects = span + layout.interAlignBytesSize > fixed ? (span + layout.interAlignBytesSize - fixed) / stride : 0;
+    return objects > 0 ? static_cast<unsigned>(objects) : 1;
+}
+
+size_t SimpleAllocator::pageSizeFor(unsigned objects) const
+{
+    //sizeof(void*) is the pointer to the next page
+    return sizeof(void*) + config_.leftAlignBytesSize + (stats_.blockSize * objects) + (config_.interAlignBytesSize*(objects-1));
+}
+
+size_t SimpleAllocator::spanFor(size_t pageSize) const
+{
+    size_t span = 1;
+    while (span < pageSize + sizeof(PageInfo*) || span < config_.alignmentBoundary)
+    {
+        span <<= 1;
+    }
+    return span;
+}
+
+unsigned SimpleAllocator::grownObjects(unsigned objects) const
+{
+    return objects < config_.maxObjectsPerPage - objects ? 2 * objects : config_.maxObjectsPerPage;
+}
+
+char* SimpleAllocator::acquirePageMemory(size_t span)
+{
+    char* newPage = nullptr;
+    if (config_.useMmap)
+    {
+        //reuse a released slot of the same span before carving new ones
+        std::vector<char*>& slots = freeSlots_[span];
+        if (!slots.empty())
+        {
+            newPage = slots.back();
+            slots.pop_back();
+        }
+        else
+        {
+            //pages are aligned to their span within the region
+            char* cursor = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(regionCursor_) + span - 1) & ~static_cast<uintptr_t>(span - 1));
+            if (regionCursor_ == nullptr || cursor + span > regionEnd_)
+            {
+                mapRegion();
+                cursor = regionCursor_;
+            }
+            newPage = cursor;
+            regionCursor_ = cursor + span;
+        }
+        //regions are aligned to their size, so the region is found by masking
+        regions_[reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(newPage) & ~static_cast<uintptr_t>(regionSize_ - 1))]++;
+        return newPage;
+    }
+
+    // Use new or malloc to allocate a new page of memory
+    //use char* for byte level memory control
+    if (config_.useCPPMemManager) //if true use new
+    {
+        newPage = static_cast<char*>(operator new[](span, std::align_val_t(span), std::nothrow));//makes a new page aligned to its span
+    } else //if false use malloc
+    {
+        newPage = static_cast<char*>(std::aligned_alloc(span, span));
+    }
+
+    // Check if memory allocation failed
+    //exception handling
+    if (newPage == nullptr) 
+    {
         throw SimpleAllocatorException(
             SimpleAllocatorException::E_NO_MEMORY,
             "Memory allocation for a new page failed."
         );
     }
-    char** storePage = reinterpret_cast<char**>(newPage);
-    *storePage = newPage;
-    //link new page in pagelist
-    Node* nextPage = reinterpret_cast<Node*>(newPage);
-    nextPage->pNext = pPageList_;
-    pPageList_ = nextPage;
+    return newPage;
+}
+
+void SimpleAllocator::releasePageMemory(char* startPage, size_t span)
+{
+    //the memory goes back clean, whoever gets it next
+    if (config_.poisonMemory)
+    {
+        unpoisonBytes(startPage, span);
+    }
+    if (!config_.useMmap)
+    {
+        //delete or free the page (allocated aligned to its span)
+        if (config_.useCPPMemManager)
+        {
+            operator delete[](startPage, std::align_val_t(span));
+        } else 
+        {
+            std::free(startPage);
+        }
+        return;
+    }
+#ifdef SIMPLEALLOCATOR_HAS_MMAP
+    char* base = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(startPage) & ~static_cast<uintptr_t>(regionSize_ - 1));
+    auto it = regions_.find(base);
+    //the last page of a region takes the whole region with it,
+    //unless pages are still being carved out of it
+    if (--it->second == 0 && base + regionSize_ != regionEnd_)
+    {
+        munmap(base, regionSize_);
+        regions_.erase(it);
+        for (auto& slots : freeSlots_)
+        {
+            slots.second.erase(std::remove_if(slots.second.begin(), slots.second.end(), 
+                [&](char* slot) { return slot >= base && slot < base + regionSize_; }), slots.second.end());
+        }
+        return;
+    }
+    //otherwise give back the OS pages that lie wholly inside this page
+    //(they read as zeros when the slot is reused)
+    uintptr_t osPage = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = (reinterpret_cast<uintptr_t>(startPage) + osPage - 1) & ~(osPage - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(startPage) + span) & ~(osPage - 1);
+    if (start < end)
+    {
+        madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+    }
+    freeSlots_[span].push_back(startPage);
+#endif
+}
+
+void SimpleAllocator::mapRegion()
+{
+#ifdef SIMPLEALLOCATOR_HAS_MMAP
+    char* base = nullptr;
+#ifdef MAP_HUGETLB
+    if (config_.hugePages == SimpleAllocatorConfig::EXPLICIT_HUGE_PAGES)
+    {
+        //huge page mappings come aligned to the huge page size
+        void* region = mmap(nullptr, regionSize_, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (region != MAP_FAILED)
+        {
+            base = static_cast<char*>(region);
+        }
+    }
+#endif
+    if (base == nullptr)
+    {
+        //map twice the size and trim, to align the region to its size
+        void* region = mmap(nullptr, 2 * regionSize_, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        //exception handling
+        if (region == MAP_FAILED) 
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_NO_MEMORY,
+                "Memory allocation for a new page failed."
+            );
+        }
+        char* raw = static_cast<char*>(region);
+        base = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + regionSize_ - 1) & ~static_cast<uintptr_t>(regionSize_ - 1));
+        if (base > raw)
+        {
+            munmap(raw, base - raw);
+        }
+        if (base + regionSize_ < raw + 2 * regionSize_)
+        {
+            munmap(base + regionSize_, raw + 2 * regionSize_ - (base + regionSize_));
+        }
+#ifdef MADV_HUGEPAGE
+        if (config_.hugePages != SimpleAllocatorConfig::NO_HUGE_PAGES)
+        {
+            madvise(base, regionSize_, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    //the previous region is no longer carved from, let it go once empty
+    if (regionCursor_ != nullptr)
+    {
+        char* previous = regionEnd_ - regionSize_;
+        auto it = regions_.find(previous);
+        if (it != regions_.end() && it->second == 0)
+        {
+            munmap(previous, regionSize_);
+            regions_.erase(it);
+            for (auto& slots : freeSlots_)
+            {
+                slots.second.erase(std::remove_if(slots.second.begin(), slots.second.end(), 
+                    [&](char* slot) { return slot >= previous && slot < previous + regionSize_; }), slots.second.end());
+            }
+        }
+    }
+    regions_[base] = 0;
+    regionCursor_ = base;
+    regionEnd_ = base + regionSize_;
+#endif
+}
+
+void SimpleAllocator::unmapRegions()
+{
+#ifdef SIMPLEALLOCATOR_HAS_MMAP
+    for (auto& region : regions_)
+    {
+        if (config_.poisonMemory)
+        {
+            unpoisonBytes(region.first, regionSize_);
+        }
+        munmap(region.first, regionSize_);
+    }
+#endif
+    regions_.clear();
+    freeSlots_.clear();
+}
+
+void* SimpleAllocator::allocate(const char* pLabel) 
+{
+    //untraced allocators only pay for this test
+    uint64_t start = pTrace_ != nullptr ? SimpleTrace::now() : 0;
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+    void* pObj = allocateImpl<false>(pLabel);
+#else
+    void* pObj = config_.isChecked ? allocateImpl<true>(pLabel) : allocateImpl<false>(pLabel);
+#endif
+    if (pTrace_ != nullptr)
+    {
+        uint64_t end = SimpleTrace::now();
+        pTrace_->record(SimpleTraceEvent::ALLOCATE, end, pObj, end - start, internLabel(pLabel));
+    }
+    if (pRecorder_ != nullptr)
+    {
+        pRecorder_->recordAllocate(recorderStream_, pObj);
+    }
+    return pObj;
+}
+
+template <bool Checked>
+void* SimpleAllocator::allocateImpl(const char* pLabel) 
+{
+    if (config_.isConcurrent)
+    {
+        MagazineScope scope(this);
+        Magazine* magazine = scope.pMagazine;
+        //refill in a batch when the magazine runs dry, from the blocks other
+        //threads have freed on this thread's pages if there are any
+        if (magazine->count == 0 && drainRemote(magazine) == 0)
+        {
+            refillMagazine(magazine, config_.magazineSize / 2);
+        }
+        //pop from the thread-local magazine, no lock needed
+        Node* allocatedBlock = magazine->pHead;
+        magazine->pHead = allocatedBlock->pNext;
+        magazine->count.store(magazine->count - 1, std::memory_order_relaxed);
+        bump(magazine->allocations);
+
+        if constexpr (Checked)
+        {
+            //only pay for a shared counter when the header records it
+            unsigned allocNum = 0;
+            if (config_.headerBlockInfo.type != SimpleAllocatorConfig::NO_HEADER)
+            {
+                allocNum = allocNum_.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+            prepareBlock(allocatedBlock, allocNum, pLabel);
+        }
+        return allocatedBlock;
+    }
+
+    // Check if there are any free blocks available
+    if (!refillFreeList() && bumpRemaining_ == 0) 
+    {
+        //at the page limit, a quarantined block is better than no block
+        if (stats_.quarantinedObjects > 0 && pageLimitReached())
+        {
+            if (!releaseQuarantined(1))
+            {
+                throw SimpleAllocatorException(
+                    SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                    "ERROR when leaving the quarantine: block written after it was freed."
+                );
+            }
+        }
+        else
+        {
+            // Allocate a new page if there are no free blocks
+            allocateNewPage();
+        }
+    }
+   
+    if constexpr (Checked)
+    {
+        //check for corruption
+        corruptionCheck(pFreeList_ != nullptr ? pFreeList_ : reinterpret_cast<Node*>(bumpNext_));
+    }
+    // Remove a block from the free list, or carve a fresh one
+    Node* allocatedBlock = takeBlock();
+    if constexpr (Checked)
+    {
+        //mark it in its page's occupancy bitmap
+        PageInfo* info = pageOf(allocatedBlock);
+        unsigned index = static_cast<unsigned>((reinterpret_cast<char*>(allocatedBlock) - info->pFirstBlock) / blockStride_);
+        info->occupancy[index / 64] |= 1ULL << (index % 64);
+    }
+
+    // Update allocation statistics
+    stats_.allocations++;
+    stats_.objectsInUse++;
+    stats_.freeObjects--;
+    if (stats_.objectsInUse > stats_.mostObjects)
+    {
+        stats_.mostObjects = stats_.objectsInUse;
+    }
+
+    if constexpr (Checked)
+    {
+        prepareBlock(allocatedBlock, stats_.allocations, pLabel);
+    }
+    // Return a pointer to the allocated block
+    return allocatedBlock;
+}
+
+void SimpleAllocator::prepareBlock(Node* allocatedBlock, unsigned allocNum, const char* pLabel)
+{
+    //check for corruption (the shared path has already done so before unlinking)
+    if (config_.isConcurrent)
+    {
+        corruptionCheck(allocatedBlock);
+    }
+    char* header = reinterpret_cast<char*>(allocatedBlock) - config_.padBytesSize - config_.headerBlockInfo.size;
+
+    // set block to allocated pattern, or hand it over unpoisoned
+    if (config_.poisonMemory)
+    {
+        unpoisonBytes(allocatedBlock, stats_.objectSize);
+    }
+    else
+    {
+        memset(allocatedBlock, ALLOCATED_PATTERN, stats_.objectSize);
+    }
+    // extended header, with mem layout:
+    // | user-defined | use count        | alloc num      | flag   |
+    // | char *       | unsigned short * | unsigned int * | bool * |
+    if(config_.headerBlockInfo.type == config_.EXTENDED_HEADER)
+    {  
+        (*header)++;//increment header with each allocation
+        unsigned short* useCount = reinterpret_cast<unsigned short*>(header + 2); 
+        *useCount = allocNum;//total no of allocations
+    }
+    // external header, with mem layout:
+    // | MemBlockInfo*  | (it stores a pointer to a MemBlockInfo struct)
+    // | MemBlockInfo** | (so the header ptr is a pointer to a pointer)
+    else if(config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+    {
+        //the info comes from the page's pool, set up with the page
+        MemBlockInfo* info = *reinterpret_cast<MemBlockInfo**>(header);
+        info->inUse = true;//store inUse value
+        info->allocNum = allocNum;//store number of allocations
+        info->pLabel = internLabel(pLabel);//equal labels share one copy
+        return; //nothing else to do if external header
+    }
+    //basic header stores the allocation value at the header
+    else if(config_.headerBlockInfo.type == config_.BASIC_HEADER)
+    {
+        *header = allocNum;
+    }
+    //no header, no flag to set
+    else
+    {
+        return;
+    }
+    //select flag location
+    char* flag = reinterpret_cast<char*>(allocatedBlock) -config_.padBytesSize - 1;
+    // Set the flag to 0x01
+    *flag = 0x01;
+}
+
+
+void SimpleAllocator::free(void* pObj) 
+{
+    uint64_t start = pTrace_ != nullptr ? SimpleTrace::now() : 0;
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+    freeImpl<false>(pObj);
+#else
+    if (config_.isChecked)
+    {
+        freeImpl<true>(pObj);
+    }
+    else
+    {
+        freeImpl<false>(pObj);
+    }
+#endif
+    if (pTrace_ != nullptr)
+    {
+        uint64_t end = SimpleTrace::now();
+        pTrace_->record(SimpleTraceEvent::FREE, end, pObj, end - start);
+    }
+}
+
+template <bool Checked>
+void SimpleAllocator::freeImpl(void* pObj) 
+{
+    //exception handling
+    if (pObj == nullptr) {
+        // Do nothing if pObj is nullptr
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+
+    if (config_.isConcurrent)
+    {
+        if constexpr (Checked)
+        {
+            releaseBlock(pObj);
+        }
+        //record it once checked, before another thread can get the block back
+        if (pRecorder_ != nullptr)
+        {
+            pRecorder_->recordFree(recorderStream_, pObj);
+        }
+        //push onto the thread-local magazine, no lock needed
+        MagazineScope scope(this);
+        Magazine* magazine = scope.pMagazine;
+        Node* freeBlock = reinterpret_cast<Node*>(pObj);
+        //a block on another live thread's page goes back to that thread
+        if (config_.remoteFrees)
+        {
+            RemoteQueue* owner = pageOf(freeBlock)->pOwner;
+            if (owner != nullptr && owner != magazine->pRemote && owner->taken.load(std::memory_order_acquire))
+            {
+                owner->push(freeBlock);
+                bump(magazine->deallocations);
+                return;
+            }
+        }
+        freeBlock->pNext = magazine->pHead;
+        magazine->pHead = freeBlock;
+        magazine->count.store(magazine->count + 1, std::memory_order_relaxed);
+        bump(magazine->deallocations);
+        //flush half of it in a batch when it overflows
+        if (magazine->count > config_.magazineSize)
+        {
+            flushMagazine(magazine, magazine->count - config_.magazineSize / 2);
+        }
+        return;
+    }
+
+    if constexpr (Checked)
+    {
+        //find the page and block by masking, and check the block is really in use
+        PageInfo* info = nullptr;
+        unsigned index = 0;
+        validateFree(pObj, info, index);
+
+        releaseBlock(pObj);
+        info->occupancy[index / 64] &= ~(1ULL << (index % 64));
+    }
+    //a free that threw above never reaches the workload
+    if (pRecorder_ != nullptr)
+    {
+        pRecorder_->recordFree(recorderStream_, pObj);
+    }
+    //store stats
+    stats_.deallocations++;
+    stats_.objectsInUse--;
+    //hold the block back in the quarantine, letting the oldest one out
+    if (config_.quarantineBytes > 0)
+    {
+        if (!quarantineBlock(reinterpret_cast<Node*>(pObj), !Checked))
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                "ERROR when leaving the quarantine: block written after it was freed."
+            );
+        }
+        return;
+    }
+    stats_.freeObjects++;
+    //link the block to the free list
+    pushFreeList(reinterpret_cast<Node*>(pObj));
+}
+
+void SimpleAllocator::releaseBlock(void* pObj)
+{
+    //check for corruption
+    corruptionCheck(reinterpret_cast<Node*>(pObj));
+    //find the start of the block
+    char* blockStart = reinterpret_cast<char*>(pObj);
+    //set the pattern for the block, or poison all of it but the free list link
+    if (config_.poisonMemory)
+    {
+        if (stats_.objectSize > sizeof(Node))
+        {
+            poisonBytes(blockStart + sizeof(Node), stats_.objectSize - sizeof(Node));
+        }
+    }
+    else
+    {
+        memset(blockStart, FREED_PATTERN, stats_.objectSize);
+    }
+    //flag sits right before the left padding
+    char* flag = reinterpret_cast<char*>(pObj) - 1 - config_.padBytesSize;
+    //find header location
+    char* header = blockStart - config_.padBytesSize - config_.headerBlockInfo.size; 
+    // extended header, with mem layout:
+    // | user-defined | use count        | alloc num      | flag   |
+    // | char *       | unsigned short * | unsigned int * | bool * |
+    if(config_.headerBlockInfo.type == config_.EXTENDED_HEADER)
+    {  
+        //set all to 0
+        unsigned short* useCount = reinterpret_cast<unsigned short*>(header + 2); 
+        *useCount = 0;
+        *flag = 00;
+
+    }
+    // external header, with mem layout:
+    // | MemBlockInfo*  | (it stores a pointer to a MemBlockInfo struct)
+    // | MemBlockInfo** | (so the header ptr is a pointer to a pointer)
+    else if(config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+    {
+        MemBlockInfo** temp = reinterpret_cast<MemBlockInfo**>(header); //find location of double pointer
+        MemBlockInfo* info = *temp;//get the info from the double pouinter
+        info->inUse = false;//store to false
+        info->pLabel = nullptr;//the interned label stays for the next block that uses it
+    }
+    //basic header
+    else if(config_.headerBlockInfo.type == config_.BASIC_HEADER)
+    {
+        //set to 0s
+        *header  = 00;
+        *flag = 00;
+    }   
+}
+
+void SimpleAllocator::allocateBatch(unsigned count, void** out, const char* pLabel)
+{
+    uint64_t start = pTrace_ != nullptr ? SimpleTrace::now() : 0;
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+    allocateBatchImpl<false>(count, out, pLabel);
+#else
+    if (config_.isChecked)
+    {
+        allocateBatchImpl<true>(count, out, pLabel);
+    }
+    else
+    {
+        allocateBatchImpl<false>(count, out, pLabel);
+    }
+#endif
+    if (pTrace_ != nullptr && count > 0)
+    {
+        //every block gets its share of the call
+        uint64_t end = SimpleTrace::now();
+        const char* pInterned = internLabel(pLabel);
+        for (unsigned i = 0; i < count; i++)
+        {
+            pTrace_->record(SimpleTraceEvent::ALLOCATE, end, out[i], (end - start) / count, pInterned);
+        }
+    }
+    if (pRecorder_ != nullptr)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            pRecorder_->recordAllocate(recorderStream_, out[i]);
+        }
+    }
+}
+
+template <bool Checked>
+void SimpleAllocator::allocateBatchImpl(unsigned count, void** out, const char* pLabel)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (config_.isConcurrent)
+    {
+        MagazineScope scope(this);
+        Magazine* magazine = scope.pMagazine;
+        unsigned taken = 0;
+        try
+        {
+            while (taken < count)
+            {
+                //one refill for everything the batch still needs
+                if (magazine->count == 0)
+                {
+                    refillMagazine(magazine, count - taken);
+                }
+                //take as much of the magazine as the batch needs
+                unsigned n = magazine->count < count - taken ? magazine->count.load() : count - taken;
+                Node* block = magazine->pHead;
+                for (unsigned i = 0; i < n; i++)
+                {
+                    out[taken++] = block;
+                    block = block->pNext;
+                }
+                magazine->pHead = block;
+                magazine->count.store(magazine->count - n, std::memory_order_relaxed);
+            }
+        }
+        catch (...)
+        {
+            //out of pages, put back what was taken so far
+            while (taken > 0)
+            {
+                Node* block = static_cast<Node*>(out[--taken]);
+                block->pNext = magazine->pHead;
+                magazine->pHead = block;
+                magazine->count.store(magazine->count + 1, std::memory_order_relaxed);
+            }
+            throw;
+        }
+        bump(magazine->allocations, count);
+
+        if constexpr (Checked)
+        {
+            //only pay for a shared counter when the header records it
+            unsigned allocNum = 0;
+            if (config_.headerBlockInfo.type != SimpleAllocatorConfig::NO_HEADER)
+            {
+                allocNum = allocNum_.fetch_add(count, std::memory_order_relaxed) + 1;
+            }
+            for (unsigned i = 0; i < count; i++)
+            {
+                prepareBlock(static_cast<Node*>(out[i]), allocNum ? allocNum + i : 0, pLabel);
+            }
+        }
+        return;
+    }
+
+    //at the page limit, quarantined blocks make up for what new pages cannot
+    if (stats_.quarantinedObjects > 0 && config_.maxPages != UNLIMITED_PAGES && count > stats_.freeObjects)
+    {
+        unsigned missing = count - stats_.freeObjects;
+        unsigned pages = stats_.pagesInUse;
+        for (unsigned objects = nextPageObjects_; missing > 0 && pages < config_.maxPages; objects = grownObjects(objects), pages++)
+        {
+            missing -= missing < objects ? missing : objects;
+        }
+        if (!releaseQuarantined(missing < stats_.quarantinedObjects ? missing : stats_.quarantinedObjects))
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                "ERROR when leaving the quarantine: block written after it was freed."
+            );
+        }
+    }
+
+    //all or nothing, so make sure the missing blocks fit in new pages first
+    unsigned missing = count > stats_.freeObjects ? count - stats_.freeObjects : 0;
+    unsigned pages = stats_.pagesInUse;
+    for (unsigned objects = nextPageObjects_; missing > 0; objects = grownObjects(objects), pages++)
+    {
+        if (config_.maxPages != UNLIMITED_PAGES && pages >= config_.maxPages) 
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_NO_PAGE,
+                "ERROR when allocating new page: maximum number of pages has been allocated."
+            );
+        }
+        missing -= missing < objects ? missing : objects;
+    }
+
+    //find the end of the chain to detach (nothing is changed until it is
+    //found); with page-local free lists, one chain per page
+    unsigned taken = 0;
+    unsigned detached = 0;
+    try
+    {
+        while (taken < count && refillFreeList())
+        {
+            Node* block = pFreeList_;
+            while (taken < count && block != nullptr)
+            {
+                if constexpr (Checked)
+                {
+                    //check for corruption
+                    corruptionCheck(block);
+                }
+                out[taken++] = block;
+                block = block->pNext;
+            }
+            //detach the whole chain in one go
+            pFreeList_ = block;
+            if (trackPages_)
+            {
+                if (pFreeList_ != nullptr && !config_.pageLocalFrees)
+                {
+                    setPrevFree(pFreeList_, nullptr);
+                }
+                for (unsigned i = detached; i < taken; i++)
+                {
+                    if (pageOf(out[i])->liveObjects++ == 0)
+                    {
+                        emptyPages_--;
+                    }
+                }
+            }
+            detached = taken;
+        }
+    }
+    catch (...)
+    {
+        //corrupted block on a later page, put back the blocks of the pages before
+        for (unsigned i = 0; i < detached; i++)
+        {
+            pushFreeList(static_cast<Node*>(out[i]));
+        }
+        throw;
+    }
+    stats_.freeObjects -= taken;
+    //carve the rest with the bump pointer, growing as needed
+    while (taken < count)
+    {
+        if (bumpRemaining_ == 0)
+        {
+            allocateNewPage();
+        }
+        out[taken++] = carveBlock();
+        stats_.freeObjects--;
+    }
+
+    // Update allocation statistics
+    unsigned firstAllocNum = stats_.allocations + 1;
+    stats_.allocations += count;
+    stats_.objectsInUse += count;
+    if (stats_.objectsInUse > stats_.mostObjects)
+    {
+        stats_.mostObjects = stats_.objectsInUse;
+    }
+
+    if constexpr (Checked)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            //mark it in its page's occupancy bitmap
+            PageInfo* info = pageOf(out[i]);
+            unsigned index = static_cast<unsigned>((static_cast<char*>(out[i]) - info->pFirstBlock) / blockStride_);
+            info->occupancy[index / 64] |= 1ULL << (index % 64);
+            prepareBlock(static_cast<Node*>(out[i]), firstAllocNum + i, pLabel);
+        }
+    }
+}
+
+void SimpleAllocator::freeBatch(unsigned count, void** in)
+{
+    uint64_t start = pTrace_ != nullptr ? SimpleTrace::now() : 0;
+#ifdef SIMPLEALLOCATOR_UNCHECKED
+    freeBatchImpl<false>(count, in);
+#else
+    if (config_.isChecked)
+    {
+        freeBatchImpl<true>(count, in);
+    }
+    else
+    {
+        freeBatchImpl<false>(count, in);
+    }
+#endif
+    if (pTrace_ != nullptr && count > 0)
+    {
+        uint64_t end = SimpleTrace::now();
+        for (unsigned i = 0; i < count; i++)
+        {
+            pTrace_->record(SimpleTraceEvent::FREE, end, in[i], (end - start) / count);
+        }
+    }
+}
+
+template <bool Checked>
+void SimpleAllocator::freeBatchImpl(unsigned count, void** in)
+{
+    //exception handling
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (in[i] == nullptr)
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_BAD_BOUNDARY,
+                "Error during free: not on a block boundary in page."
+            );
+        }
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (config_.isConcurrent)
+    {
+        MagazineScope scope(this);
+        Magazine* magazine = scope.pMagazine;
+        for (unsigned i = 0; i < count; i++)
+        {
+            if constexpr (Checked)
+            {
+                releaseBlock(in[i]);
+            }
+            if (pRecorder_ != nullptr)
+            {
+                pRecorder_->recordFree(recorderStream_, in[i]);
+            }
+            Node* freeBlock = static_cast<Node*>(in[i]);
+            bump(magazine->deallocations);
+            //a block on another live thread's page goes back to that thread, as in free()
+            if (config_.remoteFrees)
+            {
+                RemoteQueue* owner = pageOf(freeBlock)->pOwner;
+                if (owner != nullptr && owner != magazine->pRemote && owner->taken.load(std::memory_order_acquire))
+                {
+                    owner->push(freeBlock);
+                    continue;
+                }
+            }
+            //push onto the thread-local magazine, no lock needed
+            freeBlock->pNext = magazine->pHead;
+            magazine->pHead = freeBlock;
+            magazine->count.store(magazine->count + 1, std::memory_order_relaxed);
+        }
+        //one flush for the whole batch
+        if (magazine->count > config_.magazineSize)
+        {
+            flushMagazine(magazine, magazine->count - config_.magazineSize / 2);
+        }
+        return;
+    }
+
+    if constexpr (Checked)
+    {
+        //validate the whole batch before freeing anything, clearing each
+        //block's bit as we go so that a block listed twice is caught too
+        unsigned validated = 0;
+        try
+        {
+            for (; validated < count; validated++)
+            {
+                PageInfo* info = nullptr;
+                unsigned index = 0;
+                validateFree(in[validated], info, index);
+                info->occupancy[index / 64] &= ~(1ULL << (index % 64));
+            }
+        }
+        catch (...)
+        {
+            //bad pointer, undo the bits cleared so far
+            for (unsigned i = 0; i < validated; i++)
+            {
+                PageInfo* info = pageOf(in[i]);
+                unsigned index = static_cast<unsigned>((static_cast<char*>(in[i]) - info->pFirstBlock) / blockStride_);
+                info->occupancy[index / 64] |= 1ULL << (index % 64);
+            }
+            throw;
+        }
+        for (unsigned i = 0; i < count; i++)
+        {
+            releaseBlock(in[i]);
+        }
+    }
+    //only a batch that passed validation reaches the workload
+    if (pRecorder_ != nullptr)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            pRecorder_->recordFree(recorderStream_, in[i]);
+        }
+    }
+
+    //hold the batch back in the quarantine, letting the oldest blocks out
+    if (config_.quarantineBytes > 0)
+    {
+        stats_.deallocations += count;
+        stats_.objectsInUse -= count;
+        bool intact = true;
+        for (unsigned i = 0; i < count; i++)
+        {
+            intact = quarantineBlock(static_cast<Node*>(in[i]), !Checked) && intact;
+        }
+        if (!intact)
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_CORRUPTED_BLOCK,
+                "ERROR when leaving the quarantine: block written after it was freed."
+            );
+        }
+        return;
+    }
+
+    //page-local free lists sort the batch out block by block
+    if (config_.pageLocalFrees)
+    {
+        stats_.deallocations += count;
+        stats_.objectsInUse -= count;
+        stats_.freeObjects += count;
+        for (unsigned i = 0; i < count; i++)
+        {
+            pushFreeList(static_cast<Node*>(in[i]));
+        }
+        return;
+    }
+
+    //splice the batch onto the free list as one chain, last block on top
+    Node* head = pFreeList_;
+    for (unsigned i = 0; i < count; i++)
+    {
+        Node* block = static_cast<Node*>(in[i]);
+        block->pNext = head;
+        if (trackPages_ && head != nullptr)
+        {
+            setPrevFree(head, block);
+        }
+        head = block;
+    }
+    if (trackPages_)
+    {
+        setPrevFree(head, nullptr);
+    }
+    pFreeList_ = head;
+
+    //store stats
+    stats_.deallocations += count;
+    stats_.objectsInUse -= count;
+    stats_.freeObjects += count;
+
+    //only now that the free list is whole again can empty pages be released
+    //(a page empties at its last block in the batch, so no later block is on it)
+    if (trackPages_)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            PageInfo* info = pageOf(in[i]);
+            if (--info->liveObjects == 0)
+            {
+                emptyPages_++;
+                //too many empty pages lying around, give this one back now
+                if (emptyPages_ > config_.maxEmptyPages)
+                {
+                    releasePage(info);
+                }
+            }
+        }
+    }
+}
+
+void SimpleAllocator::retireMagazine(Magazine* magazine)
+{
+    flushMagazine(magazine, magazine->count);
+    std::lock_guard<std::mutex> guard(lock_);
+    retiredAllocations_ += magazine->allocations;
+    retiredDeallocations_ += magazine->deallocations;
+    //the queue stays with the allocator, for the next thread to take;
+    //blocks pushed after this wait for that thread or freeEmptyPages()
+    if (magazine->pRemote != nullptr)
+    {
+        magazine->pRemote->taken.store(false, std::memory_order_release);
+        drainRemoteToShared(magazine->pRemote);
+        magazine->pRemote = nullptr;
+    }
+}
+
+unsigned SimpleAllocator::drainRemote(Magazine* magazine)
+{
+    if (magazine->pRemote == nullptr)
+    {
+        return 0;
+    }
+    Node* last = nullptr;
+    unsigned blocks = 0;
+    Node* first = magazine->pRemote->takeAll(last, blocks);
+    if (first != nullptr)
+    {
+        last->pNext = magazine->pHead;
+        magazine->pHead = first;
+        magazine->count.store(magazine->count + blocks, std::memory_order_relaxed);
+    }
+    return blocks;
+}
+
+void SimpleAllocator::drainRemoteToShared(RemoteQueue* queue)
+{
+    Node* last = nullptr;
+    unsigned blocks = 0;
+    Node* block = queue->takeAll(last, blocks);
+    stats_.freeObjects += blocks;
+    while (block != nullptr)
+    {
+        Node* next = (block == last) ? nullptr : block->pNext;
+        pushFreeList(block);
+        block = next;
+    }
+}
+
+SimpleAllocator::Magazine* SimpleAllocator::localMagazine()
+{
+    //the thread's cache is gone, it cannot hold a magazine any more
+    if (threadCacheGone)
+    {
+        return nullptr;
+    }
+    ThreadCache& cache = threadCache_;
+    //fast path, same allocator as last time
+    if (cache.lastId == id_)
+    {
+        return cache.pLast;
+    }
+    Magazine* magazine = nullptr;
+    for (size_t i = 0; i < cache.entries.size();)
+    {
+        if (cache.entries[i].first == id_)
+        {
+            magazine = cache.entries[i].second;
+            i++;
+        }
+        //drop magazines of allocators that have been destroyed
+        else if (cache.entries[i].second->pOwner.load() == nullptr)
+        {
+            delete cache.entries[i].second;
+            cache.entries.erase(cache.entries.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+    //first use of this allocator by this thread
+    if (magazine == nullptr)
+    {
+        magazine = new Magazine(this);
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+            magazines_.push_back(magazine);
+        }
+        //take over the queue (and pages) of a thread that has exited, or start one
+        if (config_.remoteFrees)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            for (RemoteQueue* queue : remoteQueues_)
+            {
+                if (!queue->taken.load(std::memory_order_relaxed))
+                {
+                    magazine->pRemote = queue;
+                    break;
+                }
+            }
+            if (magazine->pRemote == nullptr)
+            {
+                remoteQueues_.push_back(new RemoteQueue());
+                magazine->pRemote = remoteQueues_.back();
+            }
+            magazine->pRemote->taken.store(true, std::memory_order_release);
+        }
+        cache.entries.push_back(std::make_pair(id_, magazine));
+    }
+    cache.lastId = id_;
+    cache.pLast = magazine;
+    return magazine;
+}
+
+void SimpleAllocator::refillMagazine(Magazine* magazine, unsigned batch)
+{
+    if (batch == 0)
+    {
+        batch = 1;
+    }
+    unsigned moved = 0;
+    if (config_.isLockFree)
+    {
+        Node* block = nullptr;
+        while (moved < batch && (block = popShared()) != nullptr)
+        {
+            block->pNext = magazine->pHead;
+            magazine->pHead = block;
+            moved++;
+        }
+        //shared list ran dry, grow the pool under the page lock
+        if (moved == 0)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            //other threads may steal the new blocks before we get one
+            while ((block = popShared()) == nullptr)
+            {
+                allocateNewPage();
+            }
+            block->pNext = magazine->pHead;
+            magazine->pHead = block;
+            moved++;
+        }
+        magazine->count.store(magazine->count + moved, std::memory_order_relaxed);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock_);
+    while (moved < batch)
+    {
+        //only grow when the thread would otherwise come back empty handed
+        if (moved > 0 && !refillFreeList() && bumpRemaining_ == 0)
+        {
+            break;
+        }
+        //unlink from the shared list, or carve a fresh one
+        Node* pages = pPageList_;
+        Node* block = takeBlock();
+        //a page made for this thread's refill is the thread's own
+        if (pPageList_ != pages && magazine->pRemote != nullptr)
+        {
+            pageOf(pPageList_)->pOwner = magazine->pRemote;
+        }
+        //link into the magazine
+        block->pNext = magazine->pHead;
+        magazine->pHead = block;
+        moved++;
+    }
+    stats_.freeObjects -= moved;
+    magazine->count.store(magazine->count + moved, std::memory_order_relaxed);
+    //blocks held by threads, whether in use or cached
+    unsigned held = pageObjects_ - stats_.freeObjects;
+    if (held > stats_.mostObjects)
+    {
+        stats_.mostObjects = held;
+    }
+}
+
+void SimpleAllocator::flushMagazine(Magazine* magazine, unsigned count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    //detach a chain of count blocks from the magazine without the lock
+    Node* first = magazine->pHead;
+    Node* last = first;
+    for (unsigned i = 1; i < count; i++)
+    {
+        last = last->pNext;
+    }
+    magazine->pHead = last->pNext;
+    magazine->count.store(magazine->count - count, std::memory_order_relaxed);
+
+    //splice the whole chain onto the shared list
+    if (config_.isLockFree)
+    {
+        pushShared(first, last, count);
+        return;
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    stats_.freeObjects += count;
+    while (first != nullptr)
+    {
+        Node* block = first;
+        first = (block == last) ? nullptr : block->pNext;
+        pushFreeList(block);
+    }
+}
+
+void SimpleAllocator::pushShared(Node* first, Node* last, unsigned count)
+{
+    unsigned long long head = freeHead_.load(std::memory_order_acquire);
+    do
+    {
+        last->pNext = headPtr(head);
+    } while (!freeHead_.compare_exchange_weak(head, nextHead(first, head), 
+                std::memory_order_release, std::memory_order_acquire));
+    sharedFreeObjects_.fetch_add(count, std::memory_order_relaxed);
+}
+
+Node* SimpleAllocator::popShared()
+{
+    unsigned long long head = freeHead_.load(std::memory_order_acquire);
+    while (headPtr(head) != nullptr)
+    {
+        Node* block = headPtr(head);
+        //the block may already be in a client's hands, in which case this
+        //reads garbage but the tag has moved on and the exchange fails
+        //(pages are never released while the allocator is in use)
+        Node* next = __atomic_load_n(&block->pNext, __ATOMIC_RELAXED);
+        if (freeHead_.compare_exchange_weak(head, nextHead(next, head), 
+                std::memory_order_acquire, std::memory_order_acquire))
+        {
+            sharedFreeObjects_.fetch_sub(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+    return nullptr;
+}
+
+void SimpleAllocator::signPage(char* page, unsigned objects, MemBlockInfo* infos)
+{
+    char* currentBlock = page + firstBlockOffset_;//find the position of the first block
+    //poisoning covers everything from the page link to the end of the
+    //last block, then opens up every header and free list link again
+    if (config_.poisonMemory)
+    {
+        //up to the end of the granule, or the last right pad would share
+        //it with addressable bytes (the footer is aligned, so it is clear)
+        size_t blocksEnd = firstBlockOffset_ + (objects - 1) * blockStride_ + stats_.objectSize + config_.padBytesSize;
+        blocksEnd = (blocksEnd + POISON_GRANULE - 1) & ~static_cast<size_t>(POISON_GRANULE - 1);
+        poisonBytes(page + sizeof(void*), blocksEnd - sizeof(void*));
+    }
+    //mark the leading alignment bytes
+    else if(config_.leftAlignBytesSize > 0)
+    {
+        memset(page + sizeof(void*), ALIGN_PATTERN, config_.leftAlignBytesSize);
+    }
+    //memset memory pattern to unallocated, and set 
+    for(size_t i = 0; i < objects; i++, currentBlock+=blockStride_)
+    {
+        if (config_.poisonMemory)
+        {
+            unpoisonBytes(currentBlock - config_.padBytesSize - config_.headerBlockInfo.size, config_.headerBlockInfo.size);
+            unpoisonBytes(currentBlock, sizeof(Node));
+        }
+        else
+        {
+            //alignment bytes between this block and the next
+            if(config_.interAlignBytesSize > 0 && i + 1 < objects)
+            {
+                memset(currentBlock+stats_.objectSize+config_.padBytesSize, ALIGN_PATTERN, config_.interAlignBytesSize);
+            }
+            //if padding exists, set the padding pattern
+            if(config_.padBytesSize > 0)
+            {
+                //for padding before block
+                memset(currentBlock-config_.padBytesSize, PAD_PATTERN, config_.padBytesSize);
+                //for padding after block
+                memset(currentBlock+stats_.objectSize, PAD_PATTERN, config_.padBytesSize);
+            }
+            //set the block to unallocated
+            memset(currentBlock, UNALLOCATED_PATTERN, stats_.objectSize);
+        }
+        //clear the header, the page memory may not come zeroed
+        if(config_.headerBlockInfo.size > 0)
+        {
+            char* header = currentBlock - config_.padBytesSize - config_.headerBlockInfo.size;
+            if(config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+            {
+                infos[i] = MemBlockInfo();
+                *reinterpret_cast<MemBlockInfo**>(header) = infos + i;
+            }
+            else
+            {
+                memset(header, 0, config_.headerBlockInfo.size);
+            }
+        }
+    }
+}
+
+void SimpleAllocator::allocateNewPage() 
+{
+    //a page emptied by reset() is already counted and signed, carve it again
+    if (!rewoundPages_.empty())
+    {
+        PageInfo* info = rewoundPages_.back();
+        rewoundPages_.pop_back();
+        bumpNext_ = info->pFirstBlock + (info->objects - 1) * blockStride_;
+        bumpRemaining_ = info->objects;
+        return;
+    }
+    // Check if the maximum number of pages has been reached
+    //exception handling
+    if (pageLimitReached()) 
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_NO_PAGE,
+            "ERROR when allocating new page: maximum number of pages has been allocated."
+        );
+    }
+
+    //pages grow geometrically up to config.maxObjectsPerPage
+    unsigned objects = nextPageObjects_;
+    size_t pageSize = pageSizeFor(objects);
+    size_t span = spanFor(pageSize);
+
+    //external headers point into one pool of infos per page
+    //(unchecked never fills them in)
+    MemBlockInfo* infos = nullptr;
+    if (config_.headerBlockInfo.type == config_.EXTERNAL_HEADER && config_.isChecked)
+    {
+        if (config_.useCPPMemManager) //if true use new
+        {
+            infos = new (std::nothrow) MemBlockInfo[objects]();
+        } else //if false use malloc
+        {
+            infos = static_cast<MemBlockInfo*>(std::calloc(objects, sizeof(MemBlockInfo)));
+        }
+        //exception handling
+        if (infos == nullptr) 
+        {
+            throw SimpleAllocatorException(
+                SimpleAllocatorException::E_NO_MEMORY,
+                "Memory allocation for a new page failed."
+            );
+        }
+    }
+
+    // Get the memory for a new page from new, malloc or mmap
+    //use char* for byte level memory control
+    char* newPage = nullptr;
+    try
+    {
+        newPage = acquirePageMemory(span);
+    }
+    catch (...)
+    {
+        if (config_.useCPPMemManager)
+        {
+            delete[] infos;
+        } else
+        {
+            std::free(infos);
+        }
+        throw;
+    }
+    char** storePage = reinterpret_cast<char**>(newPage);
+    *storePage = newPage;
+    //link new page in pagelist
+    Node* nextPage = reinterpret_cast<Node*>(newPage);
+    nextPage->pNext = pPageList_;
+    pPageList_ = nextPage;
+    if (pTrace_ != nullptr)
+    {
+        pTrace_->record(SimpleTraceEvent::NEW_PAGE, SimpleTrace::now(), newPage, objects);
+    }
+
+    size_t incr = firstBlockOffset_;//find the increment from the start of the page
+    //checked mode signs every block up front (the patterns are what the 
+    //dumps and corruption checks look at), the lock-free list needs every
+    //block linked; otherwise the blocks stay untouched until carved
+    if (config_.isChecked)
+    {
+        signPage(newPage, objects, infos);
+    }
+    if (config_.isLockFree)
+    {
+        char* currentBlock = newPage + incr;//find the position of the first block
+        Node* previous = nullptr; //set to null
+        for(size_t i = 0; i < objects; i++, currentBlock+=blockStride_)
+        {
+            //simple singly linked list looping, last block on top
+            Node* current = reinterpret_cast<Node*>(currentBlock);
+            current->pNext = previous;
+            previous = current;
+        }
+        //publish the whole page in one go
+        //every block of the existing pages is held by some thread right now
+        unsigned held = stats_.pagesInUse * config_.objectsPerPage - sharedFreeObjects_.load();
+        if (held > stats_.mostObjects)
+        {
+            stats_.mostObjects = held;
+        }
+        stats_.pagesInUse++;
+        stats_.pageBytes += pageSize;
+        Node* first = reinterpret_cast<Node*>(newPage + incr);
+        pushShared(previous, first, config_.objectsPerPage);
+        return;
+    }
+    //track the page so that it can be released once empty again
+    if (trackPages_)
+    {
+        PageInfo* info = new PageInfo(this, newPage, newPage + incr, objects, span);
+        if (nextPage->pNext != nullptr)
+        {
+            pageOf(nextPage->pNext)->pPrevPage = nextPage;
+        }
+        pageInfos_[newPage] = info;
+        //the footer lets a block find its page with a mask and one load
+        *reinterpret_cast<PageInfo**>(newPage + span - sizeof(PageInfo*)) = info;
+        emptyPages_++;
+    }
+    //carve from the last block down, the order a linked page used to be handed out in
+    bumpNext_ = newPage + incr + (objects - 1) * blockStride_;
+    bumpRemaining_ = objects;
+    nextPageObjects_ = grownObjects(objects);
+    // Update allocation statistics
+    stats_.pagesInUse++;
+    stats_.pageBytes += pageSize;
+    stats_.freeObjects += objects; 
+    pageObjects_ += objects;
+}
+
+Node* SimpleAllocator::carveBlock()
+{
+    Node* block = reinterpret_cast<Node*>(bumpNext_);
+    bumpNext_ -= blockStride_;
+    bumpRemaining_--;
+    if (pageOf(block)->liveObjects++ == 0)
+    {
+        emptyPages_--;
+    }
+    return block;
+}
+
+Node* SimpleAllocator::takeBlock()
+{
+    //recycled blocks first, then fresh ones off the newest page
+    if (refillFreeList())
+    {
+        return popFreeList();
+    }
+    if (bumpRemaining_ == 0)
+    {
+        allocateNewPage();
+    }
+    return carveBlock();
+}
+
+SimpleAllocator::PageInfo* SimpleAllocator::findPage(const void* block) const
+{
+    //pages are aligned to their (power of two) span, so the page starts at
+    //the address masked with one of the spans
+    for (size_t span = pageSpan_; span <= maxSpan_; span <<= 1)
+    {
+        auto it = pageInfos_.find(reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(span - 1)));
+        //a smaller page may start there without reaching the address
+        if (it != pageInfos_.end() && static_cast<const char*>(block) < it->first + it->second->span)
+        {
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+SimpleAllocator::PageInfo* SimpleAllocator::pageOf(const void* block) const
+{
+    if (maxSpan_ != pageSpan_)
+    {
+        return findPage(block);
+    }
+    char* base = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(pageSpan_ - 1));
+    return *reinterpret_cast<PageInfo**>(base + pageSpan_ - sizeof(PageInfo*));
+}
+
+const SimpleAllocator* SimpleAllocator::ownerOf(const void* pObj) const
+{
+    //the footer is only there to find with one mask when pages are tracked
+    //and all of one span
+    if (!trackPages_ || maxSpan_ != pageSpan_)
+    {
+        return nullptr;
+    }
+    return pageOf(pObj)->pAllocator;
+}
+
+bool SimpleAllocator::owns(const void* pObj) const
+{
+    if (!trackPages_)
+    {
+        return false;
+    }
+    std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+    if (config_.isConcurrent)
+    {
+        guard.lock();
+    }
+    return findPage(pObj) != nullptr;
+}
+
+void SimpleAllocator::validateFree(const void* pObj, PageInfo*& info, unsigned& index) const
+{
+    //is the address on one of our pages at all
+    info = findPage(pObj);
+    if (info == nullptr)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    //on the page, but is it on a block boundary
+    const char* block = static_cast<const char*>(pObj);
+    size_t offset = block - info->pFirstBlock;
+    if (block < info->pFirstBlock || offset % blockStride_ != 0 || offset / blockStride_ >= info->objects)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    index = static_cast<unsigned>(offset / blockStride_);
+    //on a block, but is the block allocated
+    if ((info->occupancy[index / 64] & (1ULL << (index % 64))) == 0)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_MULTIPLE_FREE,
+            "Error during free: block has already been freed."
+        );
+    }
+}
+
+void SimpleAllocator::setPrevFree(Node* block, Node* prev)
+{
+    PageInfo* info = pageOf(block);
+    info->prevFree[(reinterpret_cast<char*>(block) - info->pFirstBlock) / blockStride_] = prev;
+}
+
+Node* SimpleAllocator::popFreeList()
+{
+    Node* block = pFreeList_;
+    pFreeList_ = block->pNext;
+    if (trackPages_)
+    {
+        if (pFreeList_ != nullptr && !config_.pageLocalFrees)
+        {
+            setPrevFree(pFreeList_, nullptr);
+        }
+        if (pageOf(block)->liveObjects++ == 0)
+        {
+            emptyPages_--;
+        }
+    }
+    return block;
+}
+
+void SimpleAllocator::pushFreeList(Node* block)
+{
+    //with page-local free lists, a block of any page but the current one
+    //goes onto its own page's list
+    PageInfo* info = trackPages_ ? pageOf(block) : nullptr;
+    bool local = config_.pageLocalFrees && info != pCurrentPage_;
+    if (local)
+    {
+        if (info->localFree > 0)
+        {
+            unlinkPartial(info);
+        }
+        block->pNext = info->pLocalFree;
+        info->pLocalFree = block;
+        info->localFree++;
+    }
+    else
+    {
+        block->pNext = pFreeList_;
+        if (trackPages_ && !config_.pageLocalFrees)
+        {
+            if (pFreeList_ != nullptr)
+            {
+                setPrevFree(pFreeList_, block);
+            }
+            setPrevFree(block, nullptr);
+        }
+        pFreeList_ = block;
+    }
+    if (trackPages_)
+    {
+        --info->liveObjects;
+        if (info->liveObjects == 0)
+        {
+            emptyPages_++;
+        }
+        //one live object less, so onto the next list down
+        if (local)
+        {
+            linkPartial(info);
+        }
+        //too many empty pages lying around, give this one back now
+        if (info->liveObjects == 0 && emptyPages_ > config_.maxEmptyPages)
+        {
+            releasePage(info);
+        }
+    }
+}
+
+void SimpleAllocator::linkPartial(PageInfo* info)
+{
+    PageInfo*& head = partialPages_[info->liveObjects];
+    info->pPrevPartial = nullptr;
+    info->pNextPartial = head;
+    if (head != nullptr)
+    {
+        head->pPrevPartial = info;
+    }
+    head = info;
+    if (info->liveObjects > fullestPartial_)
+    {
+        fullestPartial_ = info->liveObjects;
+    }
+}
 
-    // Set the first block as the new free list
-    size_t incr = config_.interAlignBytesSize+config_.headerBlockInfo.size+config_.padBytesSize + sizeof(char*);//find the increment from the start of the page
-    char* currentBlock = newPage + incr;//find the position of the first block
-    Node* previous = nullptr; //set to null
-    Node* current = nullptr; //set to null
-    //memset memory pattern to unallocated, and set 
-    for(size_t i = 0; i < config_.objectsPerPage; i++, currentBlock+=stats_.blockSize)
+void SimpleAllocator::unlinkPartial(PageInfo* info)
+{
+    if (info->pPrevPartial != nullptr)
+    {
+        info->pPrevPartial->pNextPartial = info->pNextPartial;
+    }
+    else
+    {
+        partialPages_[info->liveObjects] = info->pNextPartial;
+    }
+    if (info->pNextPartial != nullptr)
+    {
+        info->pNextPartial->pPrevPartial = info->pPrevPartial;
+    }
+}
+
+bool SimpleAllocator::refillFreeList()
+{
+    if (pFreeList_ != nullptr || !config_.pageLocalFrees)
+    {
+        return pFreeList_ != nullptr;
+    }
+    //the current page is full, go on with the fullest page that is not
+    //(no page is on a list above fullestPartial_, so look down from it)
+    while (partialPages_[fullestPartial_] == nullptr)
+    {
+        if (fullestPartial_ == 0)
+        {
+            pCurrentPage_ = nullptr;
+            return false;
+        }
+        fullestPartial_--;
+    }
+    PageInfo* info = partialPages_[fullestPartial_];
+    unlinkPartial(info);
+    pFreeList_ = info->pLocalFree;
+    info->pLocalFree = nullptr;
+    info->localFree = 0;
+    pCurrentPage_ = info;
+    return true;
+}
+
+bool SimpleAllocator::quarantineBlock(Node* block, bool fill)
+{
+    //make room by letting the oldest block out
+    bool intact = true;
+    if (stats_.quarantinedObjects == quarantine_.size())
+    {
+        intact = releaseQuarantined(1);
+    }
+    //the unchecked path wrote no pattern on free, the quarantine needs one
+    if (fill)
+    {
+        memset(block, FREED_PATTERN, stats_.objectSize);
+    }
+    quarantine_[(quarantineOldest_ + stats_.quarantinedObjects) % quarantine_.size()] = block;
+    stats_.quarantinedObjects++;
+    return intact;
+}
+
+bool SimpleAllocator::releaseQuarantined(unsigned count)
+{
+    bool intact = true;
+    for (unsigned i = 0; i < count; i++)
     {
-        //if padding exists, set the padding pattern
-        if(config_.padBytesSize > 0)
+        Node* block = quarantine_[quarantineOldest_];
+        quarantineOldest_ = (quarantineOldest_ + 1) % quarantine_.size();
+        stats_.quarantinedObjects--;
+        //a write after free shows as a byte that lost the pattern
+        //(a poisoned block was reported when it was written)
+        if (!config_.poisonMemory)
         {
-            //for padding before block
-            memset(currentBlock-config_.padBytesSize, PAD_PATTERN, config_.padBytesSize);
-            //for padding after block
-            memset(currentBlock+stats_.objectSize, PAD_PATTERN, config_.padBytesSize);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(block);
+            for (size_t j = 0; j < stats_.objectSize && intact; j++)
+            {
+                intact = bytes[j] == FREED_PATTERN;
+            }
         }
-        //set the block to unallocated
-        memset(currentBlock, UNALLOCATED_PATTERN, stats_.objectSize);
+        stats_.freeObjects++;
+        pushFreeList(block);
+    }
+    return intact;
+}
+
+unsigned SimpleAllocator::flushQuarantine()
+{
+    unsigned count = stats_.quarantinedObjects;
+    if (!releaseQuarantined(count))
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_CORRUPTED_BLOCK,
+            "ERROR when leaving the quarantine: block written after it was freed."
+        );
+    }
+    return count;
+}
 
+bool SimpleAllocator::pageLimitReached() const
+{
+    //a page rewound by reset() can still be carved
+    return config_.maxPages != UNLIMITED_PAGES && stats_.pagesInUse >= config_.maxPages && rewoundPages_.empty();
+}
 
-        //simple singly linked list looping
-        //set the inital current block
-        current = reinterpret_cast<Node*>(currentBlock);
-        //for the first instance on the block
-        if(i == 0)  
+void SimpleAllocator::releasePage(PageInfo* info)
+{
+    //unlink every block of the page from the free list, O(objectsPerPage)
+    //(on the page being carved, the blocks below the bump pointer were never
+    //handed out, so they are not on the list)
+    unsigned firstLinked = 0;
+    if (bumpRemaining_ > 0 && pageOf(reinterpret_cast<Node*>(bumpNext_)) == info)
+    {
+        firstLinked = bumpRemaining_;
+        bumpNext_ = nullptr;
+        bumpRemaining_ = 0;
+    }
+    //a page rewound by reset() has no block on the list at all
+    auto rewound = std::find(rewoundPages_.begin(), rewoundPages_.end(), info);
+    if (rewound != rewoundPages_.end())
+    {
+        firstLinked = info->objects;
+        rewoundPages_.erase(rewound);
+    }
+    //with page-local free lists, the page's blocks are all on one list
+    if (config_.pageLocalFrees)
+    {
+        if (info == pCurrentPage_)
+        {
+            pFreeList_ = nullptr;
+            pCurrentPage_ = nullptr;
+        }
+        else if (info->localFree > 0)
+        {
+            unlinkPartial(info);
+        }
+        firstLinked = info->objects;
+    }
+    char* currentBlock = info->pFirstBlock + firstLinked * blockStride_;
+    for (unsigned i = firstLinked; i < info->objects; i++, currentBlock += blockStride_)
+    {
+        Node* block = reinterpret_cast<Node*>(currentBlock);
+        Node* prev = info->prevFree[i];
+        Node* next = block->pNext;
+        if (prev != nullptr)
         {
-            current->pNext = pFreeList_;//will be null if first block of the first page
+            prev->pNext = next;
         }
-        //for all other instances of the block
         else
         {
-            current->pNext = previous;
+            pFreeList_ = next;
+        }
+        if (next != nullptr)
+        {
+            setPrevFree(next, prev);
         }
-        //previous to store current
-        previous = current;
     }
-    //link the last block to the free list
-    pFreeList_ = current;
+
+    //unlink the page from the page list
+    Node* page = reinterpret_cast<Node*>(info->pPage);
+    if (info->pPrevPage != nullptr)
+    {
+        info->pPrevPage->pNext = page->pNext;
+    }
+    else
+    {
+        pPageList_ = page->pNext;
+    }
+    if (page->pNext != nullptr)
+    {
+        pageOf(page->pNext)->pPrevPage = info->pPrevPage;
+    }
+
+    if (pTrace_ != nullptr)
+    {
+        pTrace_->record(SimpleTraceEvent::FREE_PAGE, SimpleTrace::now(), info->pPage, info->objects);
+    }
+    pageInfos_.erase(info->pPage);
+    freePage(info->pPage, info->span);
+
     // Update allocation statistics
-    stats_.pagesInUse++;
-    stats_.freeObjects += config_.objectsPerPage; 
+    emptyPages_--;
+    stats_.pagesInUse--;
+    stats_.pageBytes -= pageSizeFor(info->objects);
+    stats_.freeObjects -= info->objects;
+    pageObjects_ -= info->objects;
+    delete info;
+    stats_.pagesFreed++;
+}
+
+unsigned SimpleAllocator::freeEmptyPages()
+{
+    //nothing is tracked with the lock-free list
+    if (!trackPages_)
+    {
+        return 0;
+    }
+    std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+    if (config_.isConcurrent)
+    {
+        guard.lock();
+    }
+    //blocks freed to threads that have since exited are free all the same
+    for (RemoteQueue* queue : remoteQueues_)
+    {
+        if (!queue->taken.load(std::memory_order_acquire))
+        {
+            drainRemoteToShared(queue);
+        }
+    }
+    unsigned released = 0;
+    for (auto it = pageInfos_.begin(); it != pageInfos_.end();)
+    {
+        PageInfo* info = it->second;
+        ++it;
+        if (info->liveObjects == 0)
+        {
+            releasePage(info);
+            released++;
+        }
+    }
+    return released;
+}
+
+template <typename Fn>
+unsigned SimpleAllocator::forEachInUse(Fn fn, bool countOnly) const
+{
+    //checked single-threaded mode keeps the bitmaps up to date; otherwise
+    //start from every carved block and take away the free ones
+    bool derived = !config_.isChecked || config_.isConcurrent;
+    std::unordered_map<const PageInfo*, std::vector<unsigned long long>> bitmaps;
+    if (derived)
+    {
+        for (const auto& entry : pageInfos_)
+        {
+            const PageInfo* info = entry.second;
+            std::vector<unsigned long long>& bits = bitmaps[info];
+            bits.assign(info->occupancy.size(), ~0ULL);
+            if (info->objects % 64 != 0)
+            {
+                bits.back() = (1ULL << (info->objects % 64)) - 1;
+            }
+        }
+        //pages rewound by reset() are not carved at all yet
+        for (const PageInfo* info : rewoundPages_)
+        {
+            bitmaps[info].assign(info->occupancy.size(), 0);
+        }
+        //the blocks of the bump page below the bump pointer were never carved
+        if (bumpRemaining_ > 0)
+        {
+            std::vector<unsigned long long>& bits = bitmaps[pageOf(bumpNext_)];
+            for (unsigned i = 0; i < bumpRemaining_ / 64; i++)
+            {
+                bits[i] = 0;
+            }
+            if (bumpRemaining_ % 64 != 0)
+            {
+                bits[bumpRemaining_ / 64] &= ~((1ULL << (bumpRemaining_ % 64)) - 1);
+            }
+        }
+        auto clearBlock = [&](const Node* block)
+        {
+            const PageInfo* info = pageOf(block);
+            size_t index = (reinterpret_cast<const char*>(block) - info->pFirstBlock) / blockStride_;
+            bitmaps[info][index / 64] &= ~(1ULL << (index % 64));
+        };
+        for (const Node* block = pFreeList_; block != nullptr; block = block->pNext)
+        {
+            clearBlock(block);
+        }
+        for (const auto& entry : pageInfos_)
+        {
+            for (const Node* block = entry.second->pLocalFree; block != nullptr; block = block->pNext)
+            {
+                clearBlock(block);
+            }
+        }
+        for (unsigned i = 0; i < stats_.quarantinedObjects; i++)
+        {
+            clearBlock(quarantine_[(quarantineOldest_ + i) % quarantine_.size()]);
+        }
+    }
+
+    //one word covers 64 blocks, skipped in one go when they are all free
+    unsigned count = 0;
+    for (Node* page = pPageList_; page != nullptr; page = page->pNext)
+    {
+        const PageInfo* info = pageInfos_.find(reinterpret_cast<char*>(page))->second;
+        const std::vector<unsigned long long>& bits = derived ? bitmaps[info] : info->occupancy;
+        for (size_t w = 0; w < bits.size(); w++)
+        {
+            unsigned long long word = bits[w];
+            if (countOnly)
+            {
+                count += bitCount(word);
+                continue;
+            }
+            for (; word != 0; word &= word - 1)
+            {
+                fn(info->pFirstBlock + (w * 64 + lowestBit(word)) * blockStride_);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+unsigned SimpleAllocator::dumpMemoryInUse(DUMPCALLBACK fn) const
+{
+    //nothing is tracked with the lock-free list
+    if (!trackPages_)
+    {
+        return 0;
+    }
+    std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+    if (config_.isConcurrent)
+    {
+        guard.lock();
+    }
+    size_t size = stats_.objectSize;
+    return forEachInUse([fn, size](const char* block) { fn(block, size); }, fn == nullptr);
+}
+
+unsigned SimpleAllocator::reset()
+{
+    if (config_.isConcurrent)
+    {
+        return 0;
+    }
+    //a recorded run has to see the blocks go, or its replay would keep them
+    unsigned freed = stats_.objectsInUse;
+    if (pRecorder_ != nullptr)
+    {
+        forEachInUse([this](const char* block) { pRecorder_->recordFree(recorderStream_, block); }, false);
+    }
+    //drop the free lists and the quarantine, nothing on them is touched
+    pFreeList_ = nullptr;
+    pCurrentPage_ = nullptr;
+    std::fill(partialPages_.begin(), partialPages_.end(), nullptr);
+    fullestPartial_ = 0;
+    quarantineOldest_ = 0;
+    stats_.quarantinedObjects = 0;
+    bumpNext_ = nullptr;
+    bumpRemaining_ = 0;
+    //every page is empty and uncarved again, the first page of the list is
+    //carved first
+    rewoundPages_.clear();
+    for (Node* page = pPageList_; page != nullptr; page = page->pNext)
+    {
+        PageInfo* info = pageInfos_.find(reinterpret_cast<char*>(page))->second;
+        info->liveObjects = 0;
+        info->pLocalFree = nullptr;
+        info->localFree = 0;
+        std::fill(info->occupancy.begin(), info->occupancy.end(), 0);
+        if (config_.isChecked)
+        {
+            MemBlockInfo* infos = nullptr;
+            if (config_.headerBlockInfo.type == config_.EXTERNAL_HEADER)
+            {
+                infos = *reinterpret_cast<MemBlockInfo**>(info->pFirstBlock - config_.padBytesSize - config_.headerBlockInfo.size);
+            }
+            signPage(info->pPage, info->objects, infos);
+        }
+        rewoundPages_.push_back(info);
+    }
+    std::reverse(rewoundPages_.begin(), rewoundPages_.end());
+    emptyPages_ = stats_.pagesInUse;
+    stats_.deallocations += freed;
+    stats_.objectsInUse = 0;
+    stats_.freeObjects = pageObjects_;
+    //keep no more empty pages than asked for
+    while (emptyPages_ > config_.maxEmptyPages)
+    {
+        releasePage(rewoundPages_.front());
+    }
+    return freed;
+}
+
+unsigned SimpleAllocator::releaseAll()
+{
+    if (config_.isConcurrent)
+    {
+        return 0;
+    }
+    if (pRecorder_ != nullptr)
+    {
+        forEachInUse([this](const char* block) { pRecorder_->recordFree(recorderStream_, block); }, false);
+    }
+    //every page goes as it is, its blocks unseen
+    unsigned released = stats_.pagesInUse;
+    while (pPageList_ != nullptr)
+    {
+        char* page = reinterpret_cast<char*>(pPageList_);
+        pPageList_ = pPageList_->pNext;
+        PageInfo* info = pageInfos_.find(page)->second;
+        if (pTrace_ != nullptr)
+        {
+            pTrace_->record(SimpleTraceEvent::FREE_PAGE, SimpleTrace::now(), page, info->objects);
+        }
+        freePage(page, info->span);
+        delete info;
+    }
+    pageInfos_.clear();
+    rewoundPages_.clear();
+    pFreeList_ = nullptr;
+    pCurrentPage_ = nullptr;
+    std::fill(partialPages_.begin(), partialPages_.end(), nullptr);
+    fullestPartial_ = 0;
+    quarantineOldest_ = 0;
+    bumpNext_ = nullptr;
+    bumpRemaining_ = 0;
+    sweepPage_ = nullptr;
+    emptyPages_ = 0;
+    //growth starts over from the first page size
+    nextPageObjects_ = config_.objectsPerPage;
+    pageObjects_ = 0;
+    stats_.deallocations += stats_.objectsInUse;
+    stats_.objectsInUse = 0;
+    stats_.quarantinedObjects = 0;
+    stats_.freeObjects = 0;
+    stats_.pagesInUse = 0;
+    stats_.pageBytes = 0;
+    stats_.pagesFreed += released;
+    return released;
+}
+
+bool SimpleAllocator::sweepsPads() const
+{
+    //unchecked pages carry no pads to check, poisoned pads must not be read
+    return config_.isChecked && !config_.poisonMemory && config_.padBytesSize > 0;
+}
+
+void SimpleAllocator::pageBlocks(const char* page, char*& first, unsigned& objects) const
+{
+    if (trackPages_)
+    {
+        PageInfo* info = pageInfos_.find(page)->second;
+        first = info->pFirstBlock;
+        objects = info->objects;
+    }
+    else//the lock-free list keeps its pages at one size
+    {
+        first = const_cast<char*>(page) + firstBlockOffset_;
+        objects = config_.objectsPerPage;
+    }
+}
+
+unsigned SimpleAllocator::checkPads(char* first, unsigned count, VALIDATECALLBACK fn) const
+{
+    unsigned corrupted = 0;
+    char* currentBlock = first;
+    for (unsigned i = 0; i < count; i++, currentBlock += blockStride_)
+    {
+        const unsigned char* before = reinterpret_cast<const unsigned char*>(currentBlock - config_.padBytesSize);
+        const unsigned char* after = reinterpret_cast<const unsigned char*>(currentBlock + stats_.objectSize);
+        for (unsigned j = 0; j < config_.padBytesSize; j++)
+        {
+            if (before[j] != PAD_PATTERN || after[j] != PAD_PATTERN)
+            {
+                fn(currentBlock, stats_.objectSize);
+                corrupted++;
+                break;
+            }
+        }
+    }
+    return corrupted;
+}
+
+unsigned SimpleAllocator::dumpCorruptedMemory(DUMPCALLBACK fn) const
+{
+    if (!sweepsPads())
+    {
+        return 0;
+    }
+    std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+    if (config_.isConcurrent)
+    {
+        guard.lock();
+    }
+    unsigned corrupted = 0;
+    for (Node* page = pPageList_; page != nullptr; page = page->pNext)
+    {
+        char* first;
+        unsigned objects;
+        pageBlocks(reinterpret_cast<char*>(page), first, objects);
+        corrupted += checkPads(first, objects, fn);
+    }
+    return corrupted;
+}
+
+unsigned SimpleAllocator::sweepCorruptedMemory(unsigned maxBlocks, VALIDATECALLBACK fn)
+{
+    if (!sweepsPads())
+    {
+        return 0;
+    }
+    std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+    if (config_.isConcurrent)
+    {
+        guard.lock();
+    }
+    //the page the sweep was on is gone, the sweep ends here
+    if (sweepPage_ != nullptr && trackPages_ && pageInfos_.find(sweepPage_) == pageInfos_.end())
+    {
+        sweepPage_ = nullptr;
+        return 0;
+    }
+    if (sweepPage_ == nullptr)
+    {
+        sweepPage_ = reinterpret_cast<char*>(pPageList_);
+        sweepIndex_ = 0;
+    }
+    unsigned corrupted = 0;
+    while (maxBlocks > 0 && sweepPage_ != nullptr)
+    {
+        char* first;
+        unsigned objects;
+        pageBlocks(sweepPage_, first, objects);
+        //(a smaller page may have taken the place of the one the sweep was on)
+        unsigned count = sweepIndex_ < objects ? std::min(objects - sweepIndex_, maxBlocks) : 0;
+        corrupted += checkPads(first + sweepIndex_ * blockStride_, count, fn);
+        maxBlocks -= count;
+        sweepIndex_ += count;
+        //on to the next page, the sweep ends after the last one
+        if (sweepIndex_ >= objects)
+        {
+            sweepPage_ = reinterpret_cast<char*>(reinterpret_cast<Node*>(sweepPage_)->pNext);
+            sweepIndex_ = 0;
+        }
+    }
+    return corrupted;
+}
+
+bool SimpleAllocator::startSweeper(VALIDATECALLBACK fn, unsigned blocksPerStep, unsigned intervalMs)
+{
+    if (!config_.isConcurrent || sweeper_.joinable())
+    {
+        return false;
+    }
+    sweeperStop_ = false;
+    sweeper_ = std::thread([this, fn, blocksPerStep, intervalMs]()
+    {
+        std::unique_lock<std::mutex> wait(sweeperLock_);
+        while (!sweeperStop_)
+        {
+            wait.unlock();
+            sweepCorruptedMemory(blocksPerStep, fn);
+            wait.lock();
+            sweeperWake_.wait_for(wait, std::chrono::milliseconds(intervalMs), [this]() { return sweeperStop_; });
+        }
+    });
+    return true;
+}
+
+void SimpleAllocator::stopSweeper()
+{
+    if (!sweeper_.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(sweeperLock_);
+        sweeperStop_ = true;
+    }
+    sweeperWake_.notify_one();
+    sweeper_.join();
 }
 
 // Setters and getters
@@ -398,6 +2794,10 @@ void SimpleAllocator::setDebug(bool _isDebug)
 
 const void* SimpleAllocator::getFreeList() const 
 {
+    if (config_.isLockFree)
+    {
+        return headPtr(freeHead_.load());
+    }
     return pFreeList_;
 }
 
@@ -411,7 +2811,87 @@ SimpleAllocatorConfig SimpleAllocator::getConfig() const
     return config_;
 }
 
+void SimpleAllocator::setRecorder(SimpleWorkloadRecorder* recorder)
+{
+    pRecorder_ = recorder;
+    if (pRecorder_ != nullptr)
+    {
+        recorderStream_ = pRecorder_->addStream(stats_.objectSize);
+    }
+}
+
+const SimpleTrace* SimpleAllocator::getTrace() const
+{
+    return pTrace_;
+}
+
+bool SimpleAllocator::isPoisoned(const void* address)
+{
+#if defined(SIMPLEALLOCATOR_HAS_ASAN)
+    return __asan_address_is_poisoned(address) != 0;
+#elif defined(SIMPLEALLOCATOR_HAS_POISONING)
+    //3: some of the byte is unaddressable (without reporting an error)
+    unsigned char bits = 0;
+    return VALGRIND_GET_VBITS(address, &bits, 1) == 3;
+#else
+    (void)address;
+    return false;
+#endif
+}
+
+bool SimpleAllocator::dumpTrace(const char* path) const
+{
+    if (pTrace_ == nullptr)
+    {
+        return false;
+    }
+    //the pages as they are now, for the viewer to work back from
+    std::vector<SimpleTracePage> pages;
+    {
+        std::unique_lock<std::mutex> guard(lock_, std::defer_lock);
+        if (config_.isConcurrent)
+        {
+            guard.lock();
+        }
+        for (const auto& entry : pageInfos_)
+        {
+            SimpleTracePage page;
+            page.address = reinterpret_cast<uintptr_t>(entry.second->pPage);
+            page.objects = entry.second->objects;
+            page.liveObjects = entry.second->liveObjects;
+            pages.push_back(page);
+        }
+    }
+    return pTrace_->dump(path, pages);
+}
+
 SimpleAllocatorStats SimpleAllocator::getStats() const 
 {
-    return stats_;
+    if (!config_.isConcurrent)
+    {
+        return stats_;
+    }
+
+    // sum up the shared stats and every thread's counters
+    std::lock_guard<std::mutex> registryGuard(registryLock);
+    std::lock_guard<std::mutex> guard(lock_);
+    SimpleAllocatorStats stats = stats_;
+    if (config_.isLockFree)
+    {
+        stats.freeObjects = sharedFreeObjects_.load();
+    }
+    stats.allocations = retiredAllocations_;
+    stats.deallocations = retiredDeallocations_;
+    for (const Magazine* magazine : magazines_)
+    {
+        stats.allocations += magazine->allocations.load(std::memory_order_relaxed);
+        stats.deallocations += magazine->deallocations.load(std::memory_order_relaxed);
+        stats.freeObjects += magazine->count.load(std::memory_order_relaxed);
+    }
+    for (const RemoteQueue* queue : remoteQueues_)
+    {
+        stats.freeObjects += queue->count.load(std::memory_order_relaxed);
+    }
+    stats.objectsInUse = stats.allocations - stats.deallocations;
+    return stats;
 }
\ No newline at end of file
@@ -12,10 +12,24 @@
 #define SIMPLEALLOCATOR_H
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <condition_variable>
+
+class SimpleTrace;
+class SimpleWorkloadRecorder;
 
 // Defaults for SimpleAllocator construction when client does not specify
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;
 static const int DEFAULT_MAX_PAGES = 3;
+static const unsigned UNLIMITED_PAGES = 0; // maxPages for no page limit
+static const int DEFAULT_MAGAZINE_SIZE = 32;
+static const unsigned DEFAULT_MAX_EMPTY_PAGES = static_cast<unsigned>(-1); // never release pages automatically
 
 /**
  * @class SimpleAllocatorException
@@ -92,6 +106,22 @@ struct SimpleAllocatorConfig
         EXTERNAL_HEADER,
     };
 
+    /**
+     * Huge page modes for pages that come from mmap (config.useMmap)
+     */
+    enum HugePageMode 
+    {
+        // plain 4 KiB pages
+        NO_HUGE_PAGES,
+
+        // ask for transparent huge pages with madvise(MADV_HUGEPAGE)
+        TRANSPARENT_HUGE_PAGES,
+
+        // map with MAP_HUGETLB (needs reserved huge pages), falling back to 
+        // transparent huge pages if none are available
+        EXPLICIT_HUGE_PAGES,
+    };
+
     /**
      * Header Block Information
      * - this struct contains information pertaining to different header types
@@ -148,17 +178,45 @@ struct SimpleAllocatorConfig
         leftAlignBytesSize(0),
         interAlignBytesSize(0),
         padBytesSize(_padBytesSize), 
-        isDebug(_isDebug){}
+        isDebug(_isDebug),
+        isConcurrent(false),
+        magazineSize(DEFAULT_MAGAZINE_SIZE),
+        isLockFree(false),
+        maxEmptyPages(DEFAULT_MAX_EMPTY_PAGES),
+        isChecked(true),
+        useMmap(false),
+        hugePages(NO_HUGE_PAGES),
+        maxObjectsPerPage(0),
+        traceEvents(0),
+        poisonMemory(false),
+        quarantineBytes(0),
+        isArena(false),
+        remoteFrees(false),
+        pageLocalFrees(false){}
 
     bool useCPPMemManager; // Use C++ memory manager (operator new) instead of malloc
     unsigned objectsPerPage; // Number of objects per page
-    unsigned maxPages; // Maximum number of pages
+    unsigned maxPages; // Maximum number of pages (UNLIMITED_PAGES for no limit)
     HeaderBlockInfo headerBlockInfo; // Header block information
-    unsigned alignmentBoundary; // the boundary to align to
+    unsigned alignmentBoundary; // the boundary to align the data of every block to (a power of two, 0 for none)
     unsigned leftAlignBytesSize; // num bytes in left alignment (computed from alignmentBoundary)
     unsigned interAlignBytesSize; // num bytes in inter alignment (computed from alignmentBoundary)
     unsigned padBytesSize; // num bytes in padding
     bool isDebug; // True if debug mode is on
+    bool isConcurrent; // True if the allocator is shared between threads (see thread magazines below)
+    unsigned magazineSize; // max free blocks cached per thread in concurrent mode (0 disables caching)
+    bool isLockFree; // True to use a lock-free shared free list in concurrent mode (instead of a mutex)
+    unsigned maxEmptyPages; // empty pages kept before they are released automatically
+    bool isChecked; // False for the release fast path (no patterns, pad checks, headers or free() validation)
+    bool useMmap; // True to carve pages out of 2 MiB mmap regions (instead of new or malloc)
+    HugePageMode hugePages; // huge pages for the mmap regions
+    unsigned maxObjectsPerPage; // each new page doubles the objects of the last, up to this many (0 for fixed size pages, not with the lock-free list)
+    unsigned traceEvents; // events kept in the trace ring buffer (0 for no tracing, see SimpleTrace.h)
+    bool poisonMemory; // True to poison pad bytes and freed blocks instead of writing and checking the patterns (checked mode, AddressSanitizer or Valgrind builds only)
+    size_t quarantineBytes; // object bytes of freed blocks held back from reuse, oldest first (0 for no quarantine, not in concurrent mode)
+    bool isArena; // True if the client drops all blocks at once with reset() or releaseAll(), so containers skip their per-block frees (not in concurrent mode)
+    bool remoteFrees; // True to hand blocks freed by another thread back to the thread whose page they are on (concurrent mode with the mutex and fixed size pages, see remote frees below)
+    bool pageLocalFrees; // True to keep the free blocks of each page on a list of their own and allocate from the fullest page first (not with the lock-free list, see page-local frees below)
 };
 
 /**
@@ -166,7 +224,7 @@ struct SimpleAllocatorConfig
  */
 struct MemBlockInfo {
     bool inUse; // True if block is in use
-    char* pLabel; // dynamically allocated NUL-terminated string
+    const char* pLabel; // interned NUL-terminated string, shared by every block with the same label
     unsigned allocNum; // allocation number
 };
 
@@ -188,17 +246,27 @@ struct SimpleAllocatorStats
         pagesInUse(0), 
         mostObjects(0), 
         allocations(0), 
-        deallocations(0) {}
+        deallocations(0),
+        pagesFreed(0),
+        quarantinedObjects(0),
+        alignBytes(0),
+        overheadBytes(0),
+        pageBytes(0) {}
 
     size_t objectSize;      // fixed size of each object
     size_t blockSize;       // calculated size of each block
-    size_t pageSize;        // fixed size of each page
+    size_t pageSize;        // size of each page (of the first page, if pages grow), plus the historical padBytesSize * maxPages
     unsigned freeObjects;   // current number of free objects
     unsigned objectsInUse; // current number of objects in use
     unsigned pagesInUse; // current number of pages in use
     unsigned mostObjects; // most objects in use over lifetime
     unsigned allocations; // total number of allocations over lifetime
     unsigned deallocations; // total number of deallocations over lifetime
+    unsigned pagesFreed; // total number of empty pages released over lifetime
+    unsigned quarantinedObjects; // freed blocks held back in the quarantine (neither free nor in use)
+    size_t alignBytes; // alignment bytes in each page (left + inter-block)
+    size_t overheadBytes; // bytes in each page not holding objects (page link, headers, pads and alignment)
+    size_t pageBytes; // memory currently held in pages (sum of their sizes)
 };
 
 /**
@@ -218,6 +286,38 @@ struct Node {
 
 /**
  * The SimpleAllocator class
+ * - in concurrent mode (config.isConcurrent), every thread keeps a bounded
+ *   "magazine" of free blocks, so allocate() and free() only touch 
+ *   thread-local state; the shared free list and page list are only locked
+ *   when a magazine is refilled or flushed in batches of magazineSize / 2
+ * - with config.isLockFree as well, the shared free list becomes a lock-free
+ *   stack (with a versioned head against ABA) and the mutex is only taken 
+ *   to allocate a new page
+ * - with config.poisonMemory in an AddressSanitizer build (or a Valgrind
+ *   build, -DSIMPLEALLOCATOR_VALGRIND, run under memcheck), pad bytes,
+ *   alignment bytes and freed blocks are poisoned instead of filled with
+ *   patterns, so that overruns and use-after-free are reported at the
+ *   faulting access; the first pointer-sized bytes of a free block hold
+ *   the free list link and stay addressable, and the data of every block
+ *   is aligned to at least 8 bytes (AddressSanitizer's shadow granule);
+ *   in any other build the patterns are used as before
+ * - with config.remoteFrees as well, every thread also owns the pages its
+ *   refills allocate, and a block freed by a thread other than its page's
+ *   owner is pushed onto the owner's remote-free queue (one atomic 
+ *   exchange, no lock) instead of the freeing thread's magazine; the owner
+ *   takes the whole queue in one exchange the next time its magazine runs
+ *   dry, before it would refill from the shared list; so in a producer/
+ *   consumer pipeline the consumer's frees never reach the shared list
+ *   and the producer's refills never lock it; a queue outlives its thread
+ *   and is taken over, pages and all, by the next thread to start using
+ *   the allocator
+ * - with config.pageLocalFrees, a freed block goes onto a free list of its
+ *   own page rather than one list for all pages, which after a while
+ *   interleaves the blocks of every page; blocks are handed out from one
+ *   page until it is full, then from the fullest page that has free
+ *   blocks (the most live objects), and carved from a new page last; so
+ *   blocks allocated one after the other share pages and cache lines,
+ *   and the emptiest pages are left alone to drain and be released
  */
 class SimpleAllocator {
 public:
@@ -225,17 +325,15 @@ public:
      * Callback function for dumping memory blocks
      * @param ptr pointer to memory block
      * @param size size of memory block
-     * TODO: this is unused, for future consideration
      */
-    //typedef void (*DUMPCALLBACK) (const void*, size_t);
+    typedef void (*DUMPCALLBACK) (const void*, size_t);
 
     /**
      * Callback function for validating blocks
      * @param ptr pointer to memory block
      * @param size size of memory block
-     * TODO: this is unused, for future consideration
      */
-    //typedef void (*VALIDATECALLBACK) (const void*, size_t);
+    typedef void (*VALIDATECALLBACK) (const void*, size_t);
 
     // some const values for memory signatures
     static const unsigned char UNALLOCATED_PATTERN = 0xAA; // unallocated memory never touched by the client
@@ -246,7 +344,8 @@ public:
 
     /**
      * Constructor
-     * @param objectSize object size
+     * @param objectSize object size (at least sizeof(Node) is used, the
+     *        free list link of a free block)
      * @param SimpleAllocatorConfig configuration
      * @throws SimpleAllocatorException if construction fails
      */
@@ -267,16 +366,56 @@ public:
 
     /**
      * Free (deallocate) memory
+     * - in single-threaded mode the pointer is validated in constant time:
+     *   pages are aligned to a power of two so the page is found by masking,
+     *   and each page keeps an occupancy bitmap of its blocks
      * @param obj pointer to object to deallocate
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY or E_MULTIPLE_FREE
      */
     void free(void* pObj);
 
+    /**
+     * Allocate count blocks in one call
+     * - takes a whole chain off the free list at once and carves whatever
+     *   is still missing off the bump page; stats are updated once
+     * - in single-threaded mode it is all or nothing: if the pages cannot
+     *   be allocated, nothing is taken
+     * - the blocks are not necessarily in the order count calls to 
+     *   allocate() would return them
+     * @param count number of blocks
+     * @param out array of at least count pointers, receives the blocks
+     * @param pLabel label for every block (only for EXTERNAL_HEADER)
+     * @throws SimpleAllocatorException E_NO_PAGE or E_NO_MEMORY
+     */
+    void allocateBatch(unsigned count, void** out, const char* pLabel = 0);
+
+    /**
+     * Free count blocks in one call
+     * - the blocks are spliced onto the free list as one chain, leaving it
+     *   as count calls to free() would; stats are updated once
+     * - in single-threaded mode every pointer is validated first, and if 
+     *   any is bad nothing is freed
+     * @param count number of blocks
+     * @param in array of count pointers to free
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY or E_MULTIPLE_FREE
+     */
+    void freeBatch(unsigned count, void** in);
+
     /**
      * Runs the callback fn on each block of allocated memory
-     * @param fn callback function
+     * - reads the pages' occupancy bitmaps a word at a time, so neither
+     *   headers nor patterns are needed and free blocks cost nothing
+     * - checked single-threaded mode keeps the bitmaps as it goes; other
+     *   modes derive them for the call, from the carved blocks less the
+     *   free list and the quarantine
+     * - in concurrent mode, blocks cached in the magazines of live threads
+     *   count as in use (a thread's magazine is handed back when it exits)
+     * - finds nothing with the lock-free shared list, which does not track
+     *   pages
+     * @param fn callback function, or nullptr to only count the blocks
      * @return number of blocks
      */
-    //unsigned dumpMemoryInUse(DUMPCALLBACK fn) const;
+    unsigned dumpMemoryInUse(DUMPCALLBACK fn) const;
 
     /**
      * Runs the Corruption check for block of allocated memort
@@ -286,17 +425,132 @@ public:
     void corruptionCheck(Node* blockStart);
     /**
      * Runs the callback fn on each block that is potentially corrupted
+     * - walks every block of every page and checks its pad bytes, whether
+     *   the block is allocated or not
+     * - finds nothing without pad bytes, in unchecked mode, or when the
+     *   allocator poisons (an overrun is reported as it happens then)
      * @param fn callback function
      * @return number of blocks
-     * TODO this is unimplemented, for future consideration
      */
-    //unsigned dumpCorruptedMemory(DUMPCALLBACK fn) const;
+    unsigned dumpCorruptedMemory(DUMPCALLBACK fn) const;
+
+    /**
+     * Check the pad bytes of the next maxBlocks blocks, continuing where
+     * the previous call stopped, so that a sweep over all pages can be
+     * spread over many short calls
+     * - a call never goes past the last page; the next one starts the 
+     *   next sweep from the first page, so a block that stays corrupted
+     *   is reported once per sweep
+     * - new pages go on the front of the page list and are checked from 
+     *   the next sweep on; if the page the sweep was on is released, the
+     *   sweep ends early
+     * - in concurrent mode it takes the allocator's lock for the length
+     *   of the call (only refills and flushes of the magazines wait for it)
+     * @param maxBlocks most blocks to check
+     * @param fn called for each corrupted block
+     * @return number of corrupted blocks found
+     */
+    unsigned sweepCorruptedMemory(unsigned maxBlocks, VALIDATECALLBACK fn);
+
+    /**
+     * Run sweepCorruptedMemory() on a background thread, every 
+     * intervalMs milliseconds until stopSweeper() or destruction
+     * - concurrent mode only: in single-threaded mode allocate() and free()
+     *   take no lock, so the owning thread has to call
+     *   sweepCorruptedMemory() itself, e.g. between requests
+     * - fn is called on the sweeper thread
+     * @param fn called for each corrupted block
+     * @param blocksPerStep blocks checked per step
+     * @param intervalMs pause between steps
+     * @return false if not in concurrent mode or a sweeper is running
+     */
+    bool startSweeper(VALIDATECALLBACK fn, unsigned blocksPerStep, unsigned intervalMs);
+
+    /**
+     * Stop the background sweeper and wait for its thread to finish
+     * (does nothing if none is running)
+     */
+    void stopSweeper();
 
     /**
      * Free all empty pages
-     * TODO this is unimplemented, for future consideration
+     * - a page is empty when none of its blocks are allocated
+     *   (in concurrent mode: none of its blocks are held by any thread)
+     * - pages are also released automatically once more than 
+     *   config.maxEmptyPages of them are empty
+     * - does nothing with the lock-free shared list, which does not track pages
+     * @return number of pages released
      */
-    //void freeEmptyPages();
+    unsigned freeEmptyPages();
+
+    /**
+     * Find the allocator a block in use came from, among allocators with
+     * this one's page span (the same objectSize and page layout), with a
+     * mask and two loads and without any lock
+     * - pObj must be a block that is allocated, so that its page is not
+     *   released under the call
+     * - only with tracked pages of one size (not with the lock-free shared
+     *   list or growing pages), nullptr otherwise
+     * @param pObj the block
+     * @return the allocator that handed the block out
+     */
+    const SimpleAllocator* ownerOf(const void* pObj) const;
+
+    /**
+     * Check if an address lies on one of this allocator's pages, with a
+     * hash lookup of the page, so it is safe for any address (unlike
+     * ownerOf(), nothing outside the allocator's own bookkeeping is read)
+     * - always false with the lock-free shared list, whose pages are not
+     *   tracked
+     * @param pObj the address
+     * @return true if the address is on one of the pages
+     */
+    bool owns(const void* pObj) const;
+
+    /**
+     * Get the number of objects a page can hold so that the page and its
+     * footer fit in a given span, without making an allocator
+     * @param objectSize object size
+     * @param config configuration (config.objectsPerPage is ignored)
+     * @param span bytes available for the page and its footer
+     * @return the number of objects (at least 1)
+     */
+    static unsigned objectsPerSpan(size_t objectSize, const SimpleAllocatorConfig& config, size_t span);
+
+    /**
+     * Free every block at once and rewind every page to empty, as if its
+     * blocks had never been handed out (the arena mode of config.isArena,
+     * though it works in any single-threaded mode)
+     * - no block is touched in unchecked mode: the free list and quarantine
+     *   are dropped, and the pages are carved again one after the other
+     * - checked mode signs the pages again, as it does for new pages
+     * - more than config.maxEmptyPages pages are released, not kept
+     * - does nothing in concurrent mode
+     * @return number of blocks freed
+     */
+    unsigned reset();
+
+    /**
+     * Free every block at once and release every page, leaving the
+     * allocator as it was before its first page (config.isArena)
+     * - no block is touched; a page count and growth start over
+     * - does nothing in concurrent mode
+     * @return number of pages released
+     */
+    unsigned releaseAll();
+
+    /**
+     * Let every block out of the quarantine (config.quarantineBytes),
+     * e.g. before freeEmptyPages(), since a quarantined block keeps its
+     * page from being empty
+     * - a block leaving the quarantine must still hold FREED_PATTERN all
+     *   over, unless the allocator poisons (free() and allocate() check the
+     *   same for the blocks they let out)
+     * @return number of blocks let out
+     * @throws SimpleAllocatorException (E_CORRUPTED_BLOCK) if a block was
+     *         written after it was freed; all the blocks are let out anyway
+     */
+    unsigned flushQuarantine();
 
     /**
      * Set debug state after construction
@@ -306,6 +560,10 @@ public:
 
     /**
      * Get ptr to head of internal free list
+     * - only freed blocks are on it, blocks of a new page that were never
+     *   handed out are not (except with the lock-free list)
+     * - with config.pageLocalFrees, only the free blocks of the page being
+     *   allocated from are on it
      * @return ptr to head of internal free list
      */
     const void* getFreeList() const;
@@ -322,13 +580,68 @@ public:
      */
     SimpleAllocatorConfig getConfig() const;
 
+    /**
+     * Get the event trace (config.traceEvents)
+     * @return the trace, or nullptr if tracing is off
+     */
+    const SimpleTrace* getTrace() const;
+
+    /**
+     * Write the event trace to a binary file, for traceview to read
+     * - the current pages go with it (none with the lock-free list, which
+     *   does not track them)
+     * - no thread may be using the allocator meanwhile
+     * @param path file to write
+     * @return false if tracing is off or the file could not be written
+     */
+    bool dumpTrace(const char* path) const;
+
+    /**
+     * Report every allocate and free call to a workload recorder, for
+     * replay against other configurations (see replay.cpp)
+     * - an allocator starts out reporting to the recorder of the
+     *   SIMPLEALLOCATOR_RECORD environment variable, if it is set
+     * - a free is reported before it is made, so that the block cannot be
+     *   handed out again before its free is recorded
+     * @param recorder the recorder (must outlive the allocator), or
+     *        nullptr to stop reporting
+     */
+    void setRecorder(SimpleWorkloadRecorder* recorder);
+
+    /**
+     * Check whether a byte is poisoned (config.poisonMemory)
+     * @param address the byte
+     * @return true if touching it would be reported, always false in a
+     *         build without AddressSanitizer or Valgrind
+     */
+    static bool isPoisoned(const void* address);
+
     /**
      * Get statistics struct
+     * - in concurrent mode the per-thread counters are summed up, and
+     *   freeObjects includes the blocks cached in thread magazines
      * @return statistics
      */
     SimpleAllocatorStats getStats() const;
 
 private:
+    // A thread-local cache of free blocks (defined in SimpleAllocator.cpp)
+    struct Magazine;
+
+    // Blocks freed by other threads on the pages of one thread 
+    // (defined in SimpleAllocator.cpp)
+    struct RemoteQueue;
+
+    // The per-thread list of magazines, one for each concurrent allocator
+    // the thread has used (defined in SimpleAllocator.cpp)
+    struct ThreadCache;
+    static thread_local ThreadCache threadCache_;
+
+    // The calling thread's magazine for the length of one call, or a 
+    // one-off magazine if the thread's cache is already gone
+    // (defined in SimpleAllocator.cpp)
+    struct MagazineScope;
+
     // Disable copy constructor and assignment operator
     SimpleAllocator(const SimpleAllocator&) = delete;
     SimpleAllocator& operator=(const SimpleAllocator&) = delete;
@@ -337,13 +650,398 @@ private:
     SimpleAllocatorConfig config_; // Configuration parameters
     SimpleAllocatorStats stats_; // Statistics
     Node* pFreeList_; // Head of internal free list
+    std::vector<Node*> quarantine_; // ring of quarantined blocks, room for config.quarantineBytes of them
+    size_t quarantineOldest_; // slot of the oldest quarantined block, the next to be let out
     Node* pPageList_; // Head of internal page list
+
+    // Concurrent mode only
+    unsigned long long id_; // unique id so threads never mistake a reused address for this allocator
+    mutable std::mutex lock_; // guards the shared free list, page list and stats_
+    std::vector<Magazine*> magazines_; // magazines of live threads (guarded by the registry lock)
+    unsigned retiredAllocations_; // allocations made by threads that have since exited
+    unsigned retiredDeallocations_; // deallocations made by threads that have since exited
+    std::atomic<unsigned> allocNum_; // allocation number written into block headers
+    std::atomic<unsigned long long> freeHead_; // versioned head of the shared free list (lock-free mode)
+    std::atomic<unsigned> sharedFreeObjects_; // blocks on the shared free list (lock-free mode)
+    std::vector<RemoteQueue*> remoteQueues_; // every remote-free queue, taken or not (guarded by lock_)
+
+    SimpleTrace* pTrace_; // event trace (nullptr unless config.traceEvents)
+    SimpleWorkloadRecorder* pRecorder_; // workload recorder (nullptr unless recording)
+    unsigned recorderStream_; // this allocator's stream in pRecorder_
                     
+    // Corruption sweeps
+    char* sweepPage_; // page the incremental sweep is on (nullptr: start from the first page)
+    unsigned sweepIndex_; // next block to check on sweepPage_
+    std::thread sweeper_; // background sweeper thread (concurrent mode)
+    std::mutex sweeperLock_; // guards sweeperStop_
+    std::condition_variable sweeperWake_; // wakes the sweeper early to stop
+    bool sweeperStop_; // true once the sweeper should stop
+
+    /**
+     * Get the blocks of a page
+     * @param page the page
+     * @param first receives the first block
+     * @param objects receives the number of blocks
+     */
+    void pageBlocks(const char* page, char*& first, unsigned& objects) const;
+
+    /**
+     * Check the pad bytes of consecutive blocks on one page
+     * @param first first block to check
+     * @param count number of blocks
+     * @param fn called for each corrupted block
+     * @return number of corrupted blocks
+     */
+    unsigned checkPads(char* first, unsigned count, VALIDATECALLBACK fn) const;
+
+    /**
+     * Check whether sweeps can find anything (checked mode with pad bytes
+     * that are not poisoned)
+     */
+    bool sweepsPads() const;
+
+    /**
+     * Sign the blocks of a page for checked mode: patterns (or poison),
+     * pads, alignment bytes and cleared headers
+     * @param page the page
+     * @param objects number of blocks on the page
+     * @param infos the page's external headers (EXTERNAL_HEADER only)
+     */
+    void signPage(char* page, unsigned objects, MemBlockInfo* infos);
+
+    /**
+     * Run fn on each block in use, from the occupancy bitmaps (kept in
+     * checked single-threaded mode, derived otherwise)
+     * @param fn called with each block, or counts only if countOnly
+     * @param countOnly true to count with popcount instead of calling fn
+     * @return number of blocks in use
+     */
+    template <typename Fn>
+    unsigned forEachInUse(Fn fn, bool countOnly) const;
+
     /**
      * Allocate a new page
+     * - a page rewound by reset() is carved again first
+     * - the page becomes the bump page; its blocks are carved one at a time
+     *   by carveBlock() and only reach the free list once freed
+     * - lock-free mode links the whole page onto the shared list instead
      */
     void allocateNewPage();
 
+    /**
+     * Carve the next block off the bump page (bumpRemaining_ must be > 0)
+     * @return the block
+     */
+    Node* carveBlock();
+
+    /**
+     * Take a recycled block off the free list, or else carve a fresh one
+     * (allocating a new page if need be)
+     * @return the block
+     */
+    Node* takeBlock();
+
+    // Lazy page carving (everything but the lock-free list)
+    char* bumpNext_; // next block to carve, blocks go from the last one of the page down
+    unsigned bumpRemaining_; // blocks of the bump page not carved yet
+
+    // Page tracking (everything but the lock-free list)
+    struct PageInfo; // per-page bookkeeping (defined in SimpleAllocator.cpp)
+    std::unordered_map<const char*, PageInfo*> pageInfos_; // page bookkeeping, by page address
+    bool trackPages_; // True if pageInfos_ is maintained
+    unsigned emptyPages_; // pages with no live objects
+    size_t pageSpan_; // power of two >= pageSize + footer, pages are aligned to it
+    size_t maxSpan_; // span of the largest page (pageSpan_ unless pages grow)
+    unsigned nextPageObjects_; // objects on the next new page
+    unsigned pageObjects_; // blocks over all pages
+    size_t blockStride_; // distance from one block to the next (blockSize + interAlign)
+    size_t firstBlockOffset_; // offset of the first block's data from the start of its page
+    std::vector<PageInfo*> rewoundPages_; // pages emptied by reset() and not carved again yet, the next one last
+
+    // Page-local free lists (config.pageLocalFrees)
+    PageInfo* pCurrentPage_; // the page whose free blocks are on pFreeList_
+    std::vector<PageInfo*> partialPages_; // the other pages with free blocks, by live objects (doubly linked lists)
+    unsigned fullestPartial_; // no list of partialPages_ above this one has a page
+
+    // mmap page source (config.useMmap)
+    std::unordered_map<char*, unsigned> regions_; // mapped regions by base address, with their live page count
+    std::unordered_map<size_t, std::vector<char*>> freeSlots_; // released pages in regions that are still mapped, by span
+    char* regionCursor_; // next uncarved page of the newest region
+    char* regionEnd_; // end of the newest region
+    size_t regionSize_; // 2 MiB, or the largest page span if that is bigger
+
+    /**
+     * Get the size of a page holding a number of objects
+     * @param objects number of objects on the page
+     * @return the page size
+     */
+    size_t pageSizeFor(unsigned objects) const;
+
+    /**
+     * Work out the block layout of a configuration: the poisoning the build
+     * can do, the alignment boundary and the alignment bytes
+     * @param objectSize object size (at least sizeof(Node) is used)
+     * @param config configuration, its poisonMemory, alignmentBoundary,
+     *        leftAlignBytesSize and interAlignBytesSize are set
+     * @return the block size (header, pads and object)
+     */
+    static size_t layoutBlocks(size_t objectSize, SimpleAllocatorConfig& config);
+
+    /**
+     * Get the span of a page: the power of two that holds the page and its
+     * footer (and the alignment boundary)
+     * @param pageSize size of the page
+     * @return the span
+     */
+    size_t spanFor(size_t pageSize) const;
+
+    /**
+     * Get the number of objects on the page after one of a given size
+     * @param objects number of objects on the page
+     * @return twice as many, up to config.maxObjectsPerPage
+     */
+    unsigned grownObjects(unsigned objects) const;
+
+    /**
+     * Get the memory for a new page from the configured source
+     * (new, malloc or an mmap region), aligned to its span
+     * @param span span of the page
+     * @return the page
+     * @throws SimpleAllocatorException E_NO_MEMORY
+     */
+    char* acquirePageMemory(size_t span);
+
+    /**
+     * Give the memory of a page back to its source; an mmap page is 
+     * returned to the OS with MADV_DONTNEED, or with its whole region
+     * through munmap once the region is empty
+     * @param startPage the page
+     * @param span span of the page
+     */
+    void releasePageMemory(char* startPage, size_t span);
+
+    /**
+     * Map a new region and make it the one pages are carved from
+     * @throws SimpleAllocatorException E_NO_MEMORY
+     */
+    void mapRegion();
+
+    /**
+     * Unmap every region (at destruction)
+     */
+    void unmapRegions();
+
+    // Label interning (EXTERNAL_HEADER, and labels handed to the trace)
+    std::unordered_set<std::string_view> labels_; // every distinct label, stored once for the allocator's lifetime
+    std::mutex labelLock_; // guards labels_ in concurrent mode
+
+    /**
+     * Find the stored copy of a label, storing it on first use
+     * @param pLabel the label (may be nullptr)
+     * @return the interned label (nullptr for no label)
+     */
+    const char* internLabel(const char* pLabel);
+
+    /**
+     * Release the pool of external header infos of a page
+     * @param startPage the page
+     */
+    void freeExternalHeaders(char* startPage);
+
+    /**
+     * Release the memory of a page (and any external headers in it)
+     * @param startPage the page
+     * @param span span of the page
+     */
+    void freePage(char* startPage, size_t span);
+
+    /**
+     * Find the page an address lies on by masking it with each page span
+     * in turn and looking the result up, so it is safe for any address
+     * (O(number of distinct spans), which is 1 unless pages grow)
+     * @param block the address
+     * @return the page's bookkeeping, or nullptr if it is not on a page
+     */
+    PageInfo* findPage(const void* block) const;
+
+    /**
+     * Find the page a block belongs to, through the footer of its page
+     * (only for blocks known to be ours; falls back on findPage() when
+     * pages grow, since the span is not known up front)
+     * @param block the block
+     * @return the page's bookkeeping
+     */
+    PageInfo* pageOf(const void* block) const;
+
+    /**
+     * Check that a pointer given to free() is an allocated block, in O(1)
+     * @param pObj the pointer
+     * @param info set to the page's bookkeeping
+     * @param index set to the block's index in the page
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY if pObj is not the
+     *         start of a block on one of our pages, E_MULTIPLE_FREE if the
+     *         block is not allocated
+     */
+    void validateFree(const void* pObj, PageInfo*& info, unsigned& index) const;
+
+    /**
+     * Record the predecessor of a block on the free list
+     * @param block the block
+     * @param prev its predecessor (nullptr for the head)
+     */
+    void setPrevFree(Node* block, Node* prev);
+
+    /**
+     * Unlink the head of the free list, keeping the page counts up to date
+     * @return the block
+     */
+    Node* popFreeList();
+
+    /**
+     * Push a block onto the free list, keeping the page counts up to date
+     * (and releasing the block's page if that makes too many empty pages)
+     * @param block the block
+     */
+    void pushFreeList(Node* block);
+
+    /**
+     * Put a page with free blocks on the list for its live objects
+     * (not the current page)
+     * @param info the page
+     */
+    void linkPartial(PageInfo* info);
+
+    /**
+     * Take a page off its partialPages_ list
+     * @param info the page
+     */
+    void unlinkPartial(PageInfo* info);
+
+    /**
+     * Make the fullest page with free blocks the current page once the
+     * free list has run out (config.pageLocalFrees, no-op otherwise)
+     * @return true if the free list has blocks
+     */
+    bool refillFreeList();
+
+    /**
+     * Hold a freed block back in the quarantine, letting the oldest one
+     * out first if it is full
+     * @param block the block (already counted as deallocated)
+     * @param fill true to fill it with FREED_PATTERN here (unchecked mode)
+     * @return false if the block let out had been written after its free
+     */
+    bool quarantineBlock(Node* block, bool fill);
+
+    /**
+     * Let the oldest blocks out of the quarantine onto the free list,
+     * checking that they still hold FREED_PATTERN
+     * @param count number of blocks (at most the quarantined ones)
+     * @return false if any of them had been written after its free
+     *         (they are all let out anyway, allocate() overwrites them)
+     */
+    bool releaseQuarantined(unsigned count);
+
+    /**
+     * Check whether every page the allocator may have is in use
+     * @return true if there is a page limit and it has been reached
+     */
+    bool pageLimitReached() const;
+
+    /**
+     * Unlink an empty page's blocks from the free list and release it
+     * @param info the page's bookkeeping
+     */
+    void releasePage(PageInfo* info);
+
+    /**
+     * allocate() and free() for one check policy, selected by config.isChecked
+     * - Checked: memory signatures, pad checks, headers and free() validation
+     * - !Checked: only the free list, page tracking and stats, with the 
+     *   checked code compiled out (building with -DSIMPLEALLOCATOR_UNCHECKED
+     *   forces this path for every allocator)
+     */
+    template <bool Checked> void* allocateImpl(const char* pLabel);
+    template <bool Checked> void freeImpl(void* pObj);
+    template <bool Checked> void allocateBatchImpl(unsigned count, void** out, const char* pLabel);
+    template <bool Checked> void freeBatchImpl(unsigned count, void** in);
+
+    /**
+     * Bookkeeping done on a block when it is handed to the client
+     * (corruption check, allocated pattern and header)
+     * @param block the block being allocated
+     * @param allocNum the allocation number to store in the header
+     * @param pLabel label for memory block (only for EXTERNAL_HEADER)
+     */
+    void prepareBlock(Node* block, unsigned allocNum, const char* pLabel);
+
+    /**
+     * Bookkeeping done on a block when it is returned by the client
+     * (corruption check, freed pattern and header)
+     * @param pObj the block being freed
+     */
+    void releaseBlock(void* pObj);
+
+    /**
+     * Get the calling thread's magazine, creating it on first use
+     * @return the magazine of the calling thread, or nullptr if the
+     *         thread is past its thread-local teardown (e.g. a static
+     *         object freeing memory at exit)
+     */
+    Magazine* localMagazine();
+
+    /**
+     * Hand every block and counter of a magazine back to the allocator
+     * (and the blocks on its remote-free queue, which is left for the next
+     * thread to take)
+     * @param magazine the magazine to retire
+     */
+    void retireMagazine(Magazine* magazine);
+
+    /**
+     * Move every block other threads have freed onto a magazine's 
+     * remote-free queue into the magazine
+     * @param magazine the magazine to fill
+     * @return number of blocks moved
+     */
+    unsigned drainRemote(Magazine* magazine);
+
+    /**
+     * Move every block on a remote-free queue onto the shared free list
+     * (lock_ must be held)
+     * @param queue the queue to empty
+     */
+    void drainRemoteToShared(RemoteQueue* queue);
+
+    /**
+     * Move up to batch blocks from the shared free list into a magazine,
+     * allocating a new page if the shared list is empty
+     * @param magazine the magazine to refill
+     * @param batch number of blocks wanted (allocate() asks for magazineSize / 2)
+     */
+    void refillMagazine(Magazine* magazine, unsigned batch);
+
+    /**
+     * Push a chain of blocks onto the lock-free shared free list
+     * @param first first block of the chain
+     * @param last last block of the chain
+     * @param count number of blocks in the chain
+     */
+    void pushShared(Node* first, Node* last, unsigned count);
+
+    /**
+     * Pop a block from the lock-free shared free list
+     * @return the block, or nullptr if the list is empty
+     */
+    Node* popShared();
+
+    /**
+     * Move blocks from a magazine back onto the shared free list
+     * @param magazine the magazine to flush
+     * @param count number of blocks to move
+     */
+    void flushMagazine(Magazine* magazine, unsigned count);
+
     // The private attributes and methods above are simply examples,
     // feel free to change and add your own private stuff.
 };
@@ -0,0 +1,99 @@
+/**
+ * @file SimpleMemoryResource.cpp
+ * @brief SimpleMemoryResource class definition
+ *        Routes each pmr request to a size-class pool, or to the upstream
+ *        resource when it does not fit
+ * @date 16 Oct 2026
+ */
+#include "SimpleMemoryResource.h"
+
+namespace
+{
+    // the pools' config, with the alignment boundary raised so that every
+    // fundamental alignment is met
+    SimpleAllocatorConfig alignedConfig(const SimpleAllocatorConfig& config)
+    {
+        SimpleAllocatorConfig aligned = config;
+        if (aligned.alignmentBoundary < alignof(std::max_align_t))
+        {
+            aligned.alignmentBoundary = alignof(std::max_align_t);
+        }
+        return aligned;
+    }
+}
+
+SimpleMemoryResource::SimpleMemoryResource(std::pmr::memory_resource* upstream, size_t pageBytes,
+        const SimpleAllocatorConfig& config)
+    : pools_(pageBytes, alignedConfig(config)), upstream_(upstream),
+      alignment_(alignedConfig(config).alignmentBoundary), upstreamAllocations_(0),
+      upstreamDeallocations_(0), upstreamBytes_(0)
+{
+}
+
+SimpleMemoryResource::~SimpleMemoryResource()
+{
+}
+
+bool SimpleMemoryResource::isPooled(size_t bytes, size_t alignment) const
+{
+    return alignment <= alignment_ && SizeClassAllocator::classOf(bytes) < SizeClassAllocator::NUM_SIZE_CLASSES;
+}
+
+void* SimpleMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (isPooled(bytes, alignment))
+    {
+        return pools_.allocate(bytes);
+    }
+    //too big or too aligned for the pools
+    void* p = upstream_->allocate(bytes, alignment);
+    upstreamAllocations_.fetch_add(1, std::memory_order_relaxed);
+    upstreamBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return p;
+}
+
+void SimpleMemoryResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    if (isPooled(bytes, alignment))
+    {
+        pools_.free(p, bytes);
+        return;
+    }
+    upstream_->deallocate(p, bytes, alignment);
+    upstreamDeallocations_.fetch_add(1, std::memory_order_relaxed);
+    upstreamBytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool SimpleMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+size_t SimpleMemoryResource::getAlignment() const
+{
+    return alignment_;
+}
+
+std::pmr::memory_resource* SimpleMemoryResource::upstream_resource() const
+{
+    return upstream_;
+}
+
+const SizeClassAllocator& SimpleMemoryResource::getPools() const
+{
+    return pools_;
+}
+
+SizeClassStats SimpleMemoryResource::getStats() const
+{
+    //nothing oversized reaches the pools, it goes upstream instead
+    SizeClassStats stats = pools_.getStats();
+    unsigned upstreamAllocations = upstreamAllocations_.load(std::memory_order_relaxed);
+    unsigned upstreamDeallocations = upstreamDeallocations_.load(std::memory_order_relaxed);
+    stats.oversizeAllocations = upstreamAllocations;
+    stats.oversizeInUse = upstreamAllocations - upstreamDeallocations;
+    stats.oversizeBytes = upstreamBytes_.load(std::memory_order_relaxed);
+    stats.allocations += upstreamAllocations;
+    stats.deallocations += upstreamDeallocations;
+    return stats;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file SimpleMemoryResource.h
+ * @brief SimpleMemoryResource class definition
+ *        A std::pmr::memory_resource over SimpleAllocator size-class pools,
+ *        so that the nodes of std::pmr containers (list, map,
+ *        unordered_map, ...) come out of the pools without changing the
+ *        containers
+ * @date 16 Oct 2026
+ */
+
+#ifndef SIMPLEMEMORYRESOURCE_H
+#define SIMPLEMEMORYRESOURCE_H
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include "SizeClassAllocator.h"
+
+/**
+ * The SimpleMemoryResource class
+ * - requests are routed by size and alignment: anything that fits a size
+ *   class and needs no more than the pools' alignment comes from the pool
+ *   of its class, everything else (bigger blocks, over-aligned blocks,
+ *   bucket arrays, ...) goes to the upstream resource
+ * - every pool is laid out to at least alignof(std::max_align_t), so that
+ *   any fundamental alignment can be served from a pool
+ * - deallocation is routed the same way from the size and alignment the
+ *   container gives back, so nothing is looked up
+ * - thread safety follows config.isConcurrent (the upstream resource must
+ *   be thread safe as well, the default one is)
+ */
+class SimpleMemoryResource : public std::pmr::memory_resource {
+public:
+    /**
+     * Constructor
+     * @param upstream resource for requests that do not fit a pool
+     * @param pageBytes size of a page, for every class
+     * @param config configuration for every class pool
+     *        (the alignment boundary is raised to alignof(std::max_align_t))
+     * @throws SimpleAllocatorException if construction fails
+     */
+    SimpleMemoryResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+            size_t pageBytes = DEFAULT_SLAB_PAGE_BYTES,
+            const SimpleAllocatorConfig& config = SimpleAllocatorConfig(false,
+                    DEFAULT_OBJECTS_PER_PAGE, DEFAULT_SLAB_MAX_PAGES));
+
+    /**
+     * Destructor
+     * - blocks still in use upstream are not released
+     */
+    ~SimpleMemoryResource();
+
+    /**
+     * Find out whether a request is served from a pool
+     * @param bytes size of the request
+     * @param alignment alignment of the request
+     * @return true if it goes to a pool, false if it goes upstream
+     */
+    bool isPooled(size_t bytes, size_t alignment) const;
+
+    /**
+     * Get the alignment every pooled block is guaranteed
+     * @return the alignment
+     */
+    size_t getAlignment() const;
+
+    /**
+     * Get the upstream resource
+     * @return the upstream resource
+     */
+    std::pmr::memory_resource* upstream_resource() const;
+
+    /**
+     * Get the size-class pools
+     * @return the pools
+     */
+    const SizeClassAllocator& getPools() const;
+
+    /**
+     * Get statistics struct, summed over every size class
+     * - the oversize fields count the requests sent upstream
+     * @return statistics
+     */
+    SizeClassStats getStats() const;
+
+protected:
+    /**
+     * Allocate memory from a pool, or upstream
+     * @param bytes number of bytes needed
+     * @param alignment alignment needed
+     * @return pointer to allocated memory
+     * @throws SimpleAllocatorException E_NO_PAGE or E_NO_MEMORY from a pool,
+     *         or whatever the upstream resource throws
+     */
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    /**
+     * Free memory to the pool, or upstream, it came from
+     * @param p pointer to the memory
+     * @param bytes the size it was allocated with
+     * @param alignment the alignment it was allocated with
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY or E_MULTIPLE_FREE
+     */
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    /**
+     * Memory from one resource can only go back to that same resource
+     * @param other the other resource
+     * @return true if other is this resource
+     */
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    SizeClassAllocator pools_; // one pool per size class
+    std::pmr::memory_resource* upstream_; // resource for what does not fit a pool
+    size_t alignment_; // alignment of every pooled block
+    std::atomic<unsigned> upstreamAllocations_; // upstream allocations over lifetime
+    std::atomic<unsigned> upstreamDeallocations_; // upstream deallocations over lifetime
+    std::atomic<size_t> upstreamBytes_; // bytes held upstream
+
+    // Make private to prevent copy construction and assignment
+    SimpleMemoryResource(const SimpleMemoryResource&) = delete;
+    SimpleMemoryResource& operator=(const SimpleMemoryResource&) = delete;
+};
+
+#endif // SIMPLEMEMORYRESOURCE_H
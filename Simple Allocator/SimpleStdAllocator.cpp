@@ -0,0 +1,85 @@
+/**
+ * @file SimpleStdAllocator.cpp
+ * @brief SimplePoolSet class definition
+ *        Makes and keeps the pools that SimpleStdAllocators draw from
+ * @date 16 Oct 2026
+ */
+#include "SimpleStdAllocator.h"
+
+SimplePoolSet::SimplePoolSet(const SimpleAllocatorConfig& config) : config_(config)
+{
+}
+
+SimplePoolSet::~SimplePoolSet()
+{
+    for (auto& pool : pools_)
+    {
+        delete pool.second;
+    }
+}
+
+SimplePoolSet& SimplePoolSet::defaultSet()
+{
+    static SimplePoolSet pools;
+    return pools;
+}
+
+SimpleAllocatorConfig SimplePoolSet::defaultConfig()
+{
+    SimpleAllocatorConfig config(false, DEFAULT_POOL_OBJECTS_PER_PAGE, UNLIMITED_PAGES);
+    config.maxObjectsPerPage = DEFAULT_POOL_MAX_OBJECTS_PER_PAGE;
+    config.isConcurrent = true;
+    return config;
+}
+
+SimpleAllocator* SimplePoolSet::getPool(size_t objectSize, size_t alignment)
+{
+    //a free block holds the free list link
+    if (objectSize < sizeof(void*))
+    {
+        objectSize = sizeof(void*);
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    SimpleAllocator*& pool = pools_[std::make_pair(objectSize, alignment)];
+    if (pool == nullptr)
+    {
+        SimpleAllocatorConfig config = config_;
+        if (config.alignmentBoundary < alignment)
+        {
+            config.alignmentBoundary = static_cast<unsigned>(alignment);
+        }
+        try
+        {
+            pool = new SimpleAllocator(objectSize, config);
+        }
+        catch (...)
+        {
+            //don't leave an empty entry behind
+            pools_.erase(std::make_pair(objectSize, alignment));
+            throw;
+        }
+    }
+    return pool;
+}
+
+std::vector<const SimpleAllocator*> SimplePoolSet::getPools() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    std::vector<const SimpleAllocator*> pools;
+    for (const auto& pool : pools_)
+    {
+        pools.push_back(pool.second);
+    }
+    return pools;
+}
+
+unsigned SimplePoolSet::freeEmptyPages()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    unsigned released = 0;
+    for (auto& pool : pools_)
+    {
+        released += pool.second->freeEmptyPages();
+    }
+    return released;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file SimpleStdAllocator.h
+ * @brief SimplePoolSet and SimpleStdAllocator class definitions
+ *        A standard allocator (std::allocator_traits requirements, with
+ *        rebind) that gives every node type of a node-based container
+ *        (std::set, std::map, std::list, ...) its own SimpleAllocator
+ *        pool, shared through a pool set
+ * @date 16 Oct 2026
+ */
+
+#ifndef SIMPLESTDALLOCATOR_H
+#define SIMPLESTDALLOCATOR_H
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SimpleAllocator.h"
+
+// Defaults for SimplePoolSet construction when client does not specify
+static const unsigned DEFAULT_POOL_OBJECTS_PER_PAGE = 64; // objects on the first page of a pool
+static const unsigned DEFAULT_POOL_MAX_OBJECTS_PER_PAGE = 4096; // pages grow up to this many objects
+
+/**
+ * The SimplePoolSet class
+ * - one SimpleAllocator per object size and alignment, made the first
+ *   time that size is asked for, and kept until the set is destroyed
+ * - every pool uses the set's config, with the alignment boundary raised
+ *   to the alignment asked for
+ * - finding a pool takes the set's lock; allocating from it then
+ *   follows config.isConcurrent
+ */
+class SimplePoolSet {
+public:
+    /**
+     * Constructor
+     * @param config configuration for every pool (by default pages grow
+     *        geometrically with no page limit, and the pools are
+     *        concurrent so that a set can be shared between threads)
+     */
+    SimplePoolSet(const SimpleAllocatorConfig& config = defaultConfig());
+
+    /**
+     * Destructor
+     * - releases every pool, so every container using the set must be
+     *   gone by then
+     */
+    ~SimplePoolSet();
+
+    /**
+     * Get the pool for an object size and alignment, making it if need be
+     * @param objectSize size of the objects
+     * @param alignment alignment of the objects
+     * @return the pool
+     * @throws SimpleAllocatorException if the pool cannot be made
+     */
+    SimpleAllocator* getPool(size_t objectSize, size_t alignment);
+
+    /**
+     * Get every pool made so far, by object size then alignment
+     * @return the pools
+     */
+    std::vector<const SimpleAllocator*> getPools() const;
+
+    /**
+     * Free the empty pages of every pool
+     * @return number of pages released
+     */
+    unsigned freeEmptyPages();
+
+    /**
+     * Get the set that default constructed SimpleStdAllocators use
+     * @return the default set
+     */
+    static SimplePoolSet& defaultSet();
+
+    /**
+     * Get the configuration a set uses unless told otherwise
+     * @return the default configuration
+     */
+    static SimpleAllocatorConfig defaultConfig();
+
+private:
+    SimpleAllocatorConfig config_; // configuration for every pool
+    std::map<std::pair<size_t, size_t>, SimpleAllocator*> pools_; // pools by object size and alignment
+    mutable std::mutex lock_; // guards pools_
+
+    // Make private to prevent copy construction and assignment
+    SimplePoolSet(const SimplePoolSet&) = delete;
+    SimplePoolSet& operator=(const SimplePoolSet&) = delete;
+};
+
+/**
+ * The SimpleStdAllocator class template
+ * - meets the std::allocator_traits requirements; a container rebinds it
+ *   to its node type, and the rebound allocator draws from the pool for
+ *   sizeof(node) in the same set, so node types of the same size share
+ *   one pool
+ * - single objects come from the pool, which is looked up the first time
+ *   it is needed (so rebinding to a type that is never allocated costs
+ *   nothing); arrays (n != 1, e.g. a vector's buffer or a hash table's
+ *   buckets) and over-aligned types go to aligned operator new
+ * - two allocators compare equal when they share a pool set, and the set
+ *   follows the container on copy assignment, move assignment and swap
+ * @tparam T type of object allocated
+ */
+template <typename T>
+class SimpleStdAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef SimpleStdAllocator<U> other;
+    };
+
+    /**
+     * Constructor, drawing from the default pool set
+     */
+    SimpleStdAllocator() : SimpleStdAllocator(SimplePoolSet::defaultSet()) {}
+
+    /**
+     * Constructor
+     * @param pools pool set to draw from (must outlive the allocator)
+     */
+    SimpleStdAllocator(SimplePoolSet& pools) : pools_(&pools), pool_(nullptr) {}
+
+    /**
+     * Rebinding constructor, drawing from the same pool set
+     * @param rhs allocator for another type
+     */
+    template <typename U>
+    SimpleStdAllocator(const SimpleStdAllocator<U>& rhs) : pools_(rhs.getPoolSet()), pool_(nullptr) {}
+
+    /**
+     * Allocate memory for n objects
+     * @param n number of objects
+     * @return pointer to the memory
+     * @throws SimpleAllocatorException E_NO_PAGE or E_NO_MEMORY from the
+     *         pool, std::bad_alloc from operator new
+     */
+    T* allocate(size_t n)
+    {
+        if (n == 1 && IS_POOLED)
+        {
+            return static_cast<T*>(getPool()->allocate());
+        }
+        if (n > static_cast<size_t>(-1) / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    /**
+     * Free memory for n objects
+     * @param p pointer to the memory
+     * @param n number of objects it was allocated for
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY or E_MULTIPLE_FREE
+     */
+    void deallocate(T* p, size_t n)
+    {
+        if (n == 1 && IS_POOLED)
+        {
+            getPool()->free(p);
+            return;
+        }
+        operator delete(p, n * sizeof(T), std::align_val_t(alignof(T)));
+    }
+
+    /**
+     * Get the pool set drawn from
+     * @return the pool set
+     */
+    SimplePoolSet* getPoolSet() const { return pools_; }
+
+    /**
+     * Get the pool single objects come from, looking it up on first use
+     * @return the pool (nullptr for over-aligned types)
+     * @throws SimpleAllocatorException if the pool cannot be made
+     */
+    SimpleAllocator* getPool()
+    {
+        if (pool_ == nullptr && IS_POOLED)
+        {
+            pool_ = pools_->getPool(sizeof(T), alignof(T));
+        }
+        return pool_;
+    }
+
+private:
+    // over-aligned types never go to a pool
+    static const bool IS_POOLED = alignof(T) <= alignof(std::max_align_t);
+
+    SimplePoolSet* pools_; // pool set drawn from
+    SimpleAllocator* pool_; // pool for sizeof(T), looked up on first use
+};
+
+/**
+ * Allocators are equal when memory from one can be freed by the other
+ * @param lhs an allocator
+ * @param rhs another allocator
+ * @return true if they share a pool set
+ */
+template <typename T, typename U>
+bool operator==(const SimpleStdAllocator<T>& lhs, const SimpleStdAllocator<U>& rhs)
+{
+    return lhs.getPoolSet() == rhs.getPoolSet();
+}
+
+/**
+ * Allocators differ when memory from one cannot be freed by the other
+ * @param lhs an allocator
+ * @param rhs another allocator
+ * @return true if they draw from different pool sets
+ */
+template <typename T, typename U>
+bool operator!=(const SimpleStdAllocator<T>& lhs, const SimpleStdAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+#endif // SIMPLESTDALLOCATOR_H
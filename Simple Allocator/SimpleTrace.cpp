@@ -0,0 +1,272 @@
+/**
+ * @file SimpleTrace.cpp
+ * @brief SimpleTrace class definition
+ *        Records allocator events into a ring, and writes and reads the
+ *        binary dumps of it
+ * @date 16 Oct 2026
+ */
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include "SimpleTrace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SIMPLETRACE_HAS_TSC
+#endif
+
+namespace
+{
+    // a dump starts with this, then the header below, the labels, the pages
+    // and the events
+    const char TRACE_MAGIC[8] = { 'S', 'A', 'T', 'R', 'A', 'C', 'E', '1' };
+
+    struct TraceHeader
+    {
+        uint32_t eventSize; // sizeof(SimpleTraceEvent), to reject dumps from another layout
+        uint32_t labelCount; // number of labels that follow (each a uint16_t length and its bytes)
+        uint64_t pageCount; // number of SimpleTracePages that follow the labels
+        uint64_t eventCount; // number of events that follow the pages
+        uint64_t recorded;
+        uint64_t objectSize;
+        uint64_t blockStride;
+        uint64_t firstBlockOffset;
+        double ticksPerSecond;
+    };
+
+    // small per-thread ids, handed out the first time a thread records
+    std::atomic<unsigned> nextThreadId(0);
+    thread_local unsigned threadId = nextThreadId++;
+
+    // source of SimpleTrace::id_
+    std::atomic<unsigned long long> nextTraceId(1);
+
+    // the label the calling thread looked up last, with the id of the
+    // trace it was looked up in (0 for none yet)
+    struct LabelCache
+    {
+        unsigned long long traceId;
+        const char* pLabel;
+        uint16_t labelId;
+    };
+    thread_local LabelCache lastLabel = {0, nullptr, 0};
+
+    // read count fixed-size records in chunks, so that a corrupt count
+    // does not allocate wildly before the file runs out
+    template <typename T>
+    bool readRecords(std::ifstream& file, uint64_t count, std::vector<T>& records)
+    {
+        const size_t CHUNK = 4096;
+        for (uint64_t left = count; left > 0;)
+        {
+            size_t n = left < CHUNK ? static_cast<size_t>(left) : CHUNK;
+            size_t size = records.size();
+            records.resize(size + n);
+            if (!file.read(reinterpret_cast<char*>(records.data() + size), n * sizeof(T)))
+            {
+                return false;
+            }
+            left -= n;
+        }
+        return true;
+    }
+
+    uint64_t steadyNanoseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+SimpleTrace::SimpleTrace(unsigned capacity, size_t objectSize, size_t blockStride, size_t firstBlockOffset,
+        bool isConcurrent)
+    : isConcurrent_(isConcurrent), next_(0), objectSize_(objectSize), blockStride_(blockStride),
+      firstBlockOffset_(firstBlockOffset), startTicks_(now()), startNanoseconds_(steadyNanoseconds()),
+      id_(nextTraceId++)
+{
+    //a power of two, so the slot is a mask away
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    events_.resize(size);
+    mask_ = size - 1;
+    //id 0 is "no label"
+    labels_.push_back(std::string());
+}
+
+uint64_t SimpleTrace::now()
+{
+#ifdef SIMPLETRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return steadyNanoseconds();
+#endif
+}
+
+void SimpleTrace::record(SimpleTraceEvent::Type type, uint64_t time, const void* address, uint64_t value,
+        const char* pLabel)
+{
+    //a single writer needs no locked increment
+    uint64_t slot = next_.load(std::memory_order_relaxed);
+    if (isConcurrent_)
+    {
+        slot = next_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        next_.store(slot + 1, std::memory_order_relaxed);
+    }
+    SimpleTraceEvent& event = events_[slot & mask_];
+    event.time = time;
+    event.address = reinterpret_cast<uintptr_t>(address);
+    event.value = value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+    event.labelId = pLabel != nullptr ? labelId(pLabel) : 0;
+    event.thread = static_cast<uint8_t>(threadId);
+    event.type = static_cast<uint8_t>(type);
+}
+
+uint16_t SimpleTrace::labelId(const char* pLabel)
+{
+    if (pLabel == nullptr)
+    {
+        return 0;
+    }
+    //clients tend to use the same label over and over, and an interned
+    //label is one pointer, so the thread's last one needs no lock
+    if (lastLabel.traceId == id_ && lastLabel.pLabel == pLabel)
+    {
+        return lastLabel.labelId;
+    }
+    uint16_t id = 0;
+    {
+        std::lock_guard<std::mutex> guard(labelLock_);
+        auto it = labelIds_.find(pLabel);
+        if (it != labelIds_.end())
+        {
+            id = it->second;
+        }
+        //the table is full, the rest go unlabelled
+        else if (labels_.size() <= UINT16_MAX)
+        {
+            labels_.push_back(pLabel);
+            id = static_cast<uint16_t>(labels_.size() - 1);
+            labelIds_.emplace(pLabel, id);
+        }
+    }
+    lastLabel.traceId = id_;
+    lastLabel.pLabel = pLabel;
+    lastLabel.labelId = id;
+    return id;
+}
+
+unsigned SimpleTrace::getCapacity() const
+{
+    return static_cast<unsigned>(events_.size());
+}
+
+uint64_t SimpleTrace::getRecorded() const
+{
+    return next_.load(std::memory_order_relaxed);
+}
+
+SimpleTraceDump SimpleTrace::snapshot() const
+{
+    SimpleTraceDump trace;
+    trace.objectSize = objectSize_;
+    trace.blockStride = blockStride_;
+    trace.firstBlockOffset = firstBlockOffset_;
+    //calibrate the ticks against the steady clock over the trace's lifetime
+    uint64_t nanoseconds = steadyNanoseconds() - startNanoseconds_;
+#ifdef SIMPLETRACE_HAS_TSC
+    trace.ticksPerSecond = nanoseconds > 0 ? (now() - startTicks_) * 1e9 / nanoseconds : 1e9;
+#else
+    trace.ticksPerSecond = 1e9;
+#endif
+    trace.recorded = next_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard(labelLock_);
+        trace.labels.assign(labels_.begin(), labels_.end());
+    }
+    //once the ring has wrapped the oldest event sits at the next slot
+    size_t capacity = events_.size();
+    size_t count = trace.recorded < capacity ? static_cast<size_t>(trace.recorded) : capacity;
+    size_t first = trace.recorded < capacity ? 0 : static_cast<size_t>(trace.recorded & mask_);
+    trace.events.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        trace.events.push_back(events_[(first + i) & mask_]);
+    }
+    return trace;
+}
+
+bool SimpleTrace::dump(const char* path, const std::vector<SimpleTracePage>& pages) const
+{
+    SimpleTraceDump trace = snapshot();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    TraceHeader header;
+    header.eventSize = sizeof(SimpleTraceEvent);
+    header.labelCount = static_cast<uint32_t>(trace.labels.size());
+    header.pageCount = pages.size();
+    header.eventCount = trace.events.size();
+    header.recorded = trace.recorded;
+    header.objectSize = trace.objectSize;
+    header.blockStride = trace.blockStride;
+    header.firstBlockOffset = trace.firstBlockOffset;
+    header.ticksPerSecond = trace.ticksPerSecond;
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::string& label : trace.labels)
+    {
+        uint16_t length = label.size() > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(label.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(label.data(), length);
+    }
+    file.write(reinterpret_cast<const char*>(pages.data()), pages.size() * sizeof(SimpleTracePage));
+    file.write(reinterpret_cast<const char*>(trace.events.data()), trace.events.size() * sizeof(SimpleTraceEvent));
+    return static_cast<bool>(file);
+}
+
+bool SimpleTrace::load(const char* path, SimpleTraceDump& trace)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(TRACE_MAGIC)];
+    TraceHeader header;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0
+        || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || header.eventSize != sizeof(SimpleTraceEvent))
+    {
+        return false;
+    }
+    SimpleTraceDump loaded;
+    loaded.objectSize = header.objectSize;
+    loaded.blockStride = header.blockStride;
+    loaded.firstBlockOffset = header.firstBlockOffset;
+    loaded.ticksPerSecond = header.ticksPerSecond;
+    loaded.recorded = header.recorded;
+    for (uint32_t i = 0; i < header.labelCount; i++)
+    {
+        uint16_t length = 0;
+        if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)))
+        {
+            return false;
+        }
+        std::string label(length, '\0');
+        if (!file.read(&label[0], length))
+        {
+            return false;
+        }
+        loaded.labels.push_back(label);
+    }
+    if (!readRecords(file, header.pageCount, loaded.pages) || !readRecords(file, header.eventCount, loaded.events))
+    {
+        return false;
+    }
+    trace = std::move(loaded);
+    return true;
+}
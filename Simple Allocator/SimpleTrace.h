@@ -0,0 +1,177 @@
+/**
+ * @file SimpleTrace.h
+ * @brief SimpleTrace class definition
+ *        An opt-in ring buffer of allocator events (allocate, free, new
+ *        page, released page) that can be dumped to a compact binary file
+ *        and loaded back by an offline tool (see traceview.cpp)
+ * @date 16 Oct 2026
+ */
+
+#ifndef SIMPLETRACE_H
+#define SIMPLETRACE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One traced event, 24 bytes as stored in memory and in a dump
+ */
+struct SimpleTraceEvent
+{
+    /**
+     * Event types
+     */
+    enum Type
+    {
+        ALLOCATE, // a block was handed to the client
+        FREE, // a block was returned by the client
+        NEW_PAGE, // a page was allocated
+        FREE_PAGE, // an empty page was released
+    };
+
+    uint64_t time; // ticks (TSC, or steady clock nanoseconds) when the event ended
+    uint64_t address; // the block, or the page
+    uint32_t value; // ticks the call took (ALLOCATE, FREE), or objects on the page (NEW_PAGE, FREE_PAGE)
+    uint16_t labelId; // index into the label table (0 for no label)
+    uint8_t thread; // small id of the recording thread (wraps after 256 threads)
+    uint8_t type; // one of Type
+};
+
+/**
+ * A page of the allocator at the time of a dump, so that a viewer can
+ * work the occupancy back from the end of the trace
+ */
+struct SimpleTracePage
+{
+    uint64_t address; // start of the page
+    uint32_t objects; // blocks on the page
+    uint32_t liveObjects; // blocks not on the free list (in use, or cached by a thread)
+};
+
+/**
+ * A trace as it is dumped, or loaded back from a dump
+ */
+struct SimpleTraceDump
+{
+    SimpleTraceDump() : objectSize(0), blockStride(0), firstBlockOffset(0), ticksPerSecond(0), recorded(0) {}
+
+    uint64_t objectSize; // object size of the allocator
+    uint64_t blockStride; // distance from one block to the next
+    uint64_t firstBlockOffset; // offset of the first block from the start of its page
+    double ticksPerSecond; // to turn event ticks into time
+    uint64_t recorded; // events recorded over the trace's lifetime (more than events.size() once it wrapped)
+    std::vector<std::string> labels; // label table, labels[0] is the empty "no label"
+    std::vector<SimpleTraceEvent> events; // the events still in the buffer, oldest first
+    std::vector<SimpleTracePage> pages; // pages at the time of the dump (empty if they are not tracked)
+};
+
+/**
+ * The SimpleTrace class
+ * - a fixed ring of events (a power of two): once it is full the oldest
+ *   event is overwritten, so the trace always holds the latest events
+ * - a concurrent trace takes each slot with one atomic increment, so 
+ *   threads can record at the same time (two threads only share a slot 
+ *   if the ring laps them mid-write); a label is looked up without a lock
+ *   while a thread keeps using the same one, and under a short lock when
+ *   it changes
+ * - snapshot() and dump() must not race with recording
+ */
+class SimpleTrace {
+public:
+    /**
+     * Constructor
+     * @param capacity number of events kept (rounded up to a power of two)
+     * @param objectSize object size of the allocator
+     * @param blockStride distance from one block to the next
+     * @param firstBlockOffset offset of the first block from the start of its page
+     * @param isConcurrent true if more than one thread records
+     */
+    SimpleTrace(unsigned capacity, size_t objectSize, size_t blockStride, size_t firstBlockOffset,
+            bool isConcurrent);
+
+    /**
+     * Read the clock events are timed with (the TSC where there is one)
+     * @return current ticks
+     */
+    static uint64_t now();
+
+    /**
+     * Record an event
+     * @param type event type
+     * @param time ticks when the event ended (from now())
+     * @param address the block or page
+     * @param value ticks the call took, or objects on the page
+     * @param pLabel interned label of the block (may be nullptr): equal
+     *        labels come as the same pointer, valid for the trace's lifetime
+     */
+    void record(SimpleTraceEvent::Type type, uint64_t time, const void* address, uint64_t value,
+            const char* pLabel = nullptr);
+
+    /**
+     * Get the number of events kept
+     * @return the capacity
+     */
+    unsigned getCapacity() const;
+
+    /**
+     * Get the number of events recorded over the trace's lifetime
+     * @return events recorded
+     */
+    uint64_t getRecorded() const;
+
+    /**
+     * Copy the trace, oldest event first
+     * @return the trace
+     */
+    SimpleTraceDump snapshot() const;
+
+    /**
+     * Write the trace to a binary file (native byte order)
+     * @param path file to write
+     * @param pages the allocator's pages right now
+     * @return false if the file could not be written
+     */
+    bool dump(const char* path, const std::vector<SimpleTracePage>& pages) const;
+
+    /**
+     * Read a trace written by dump()
+     * @param path file to read
+     * @param trace receives the trace
+     * @return false if the file could not be read or is not a trace
+     */
+    static bool load(const char* path, SimpleTraceDump& trace);
+
+private:
+    std::vector<SimpleTraceEvent> events_; // the ring
+    size_t mask_; // capacity - 1
+    bool isConcurrent_; // True to take slots with an atomic increment
+    std::atomic<uint64_t> next_; // events recorded so far, the next slot is next_ & mask_
+    size_t objectSize_; // object size of the allocator
+    size_t blockStride_; // distance from one block to the next
+    size_t firstBlockOffset_; // offset of the first block from the start of its page
+    uint64_t startTicks_; // clock at construction, to calibrate the TSC
+    uint64_t startNanoseconds_; // steady clock at construction, to calibrate the TSC
+
+    // Label table
+    unsigned long long id_; // unique id, so a thread's cached label is never taken for another trace's
+    std::vector<std::string> labels_; // labels by id
+    std::unordered_map<const char*, uint16_t> labelIds_; // ids by interned label
+    mutable std::mutex labelLock_; // guards labels_ and labelIds_
+
+    /**
+     * Get the id of a label, adding it to the table on first use
+     * @param pLabel the interned label (may be nullptr)
+     * @return the id (0 for no label, or once the table is full)
+     */
+    uint16_t labelId(const char* pLabel);
+
+    // Make private to prevent copy construction and assignment
+    SimpleTrace(const SimpleTrace&) = delete;
+    SimpleTrace& operator=(const SimpleTrace&) = delete;
+};
+
+#endif // SIMPLETRACE_H
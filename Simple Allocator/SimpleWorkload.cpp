@@ -0,0 +1,176 @@
+/**
+ * @file SimpleWorkload.cpp
+ * @brief SimpleWorkload and SimpleWorkloadRecorder class definitions
+ *        Captures allocate/free calls into slots, and writes and reads
+ *        workload files
+ * @date 16 Oct 2026
+ */
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "SimpleWorkload.h"
+
+namespace
+{
+    // a workload file starts with this, then the stream count, the streams,
+    // the op count and the ops
+    const char WORKLOAD_MAGIC[8] = { 'S', 'A', 'W', 'O', 'R', 'K', '1', '\0' };
+
+    // read count fixed-size records in chunks, so that a corrupt count
+    // does not allocate wildly before the file runs out
+    template <typename T>
+    bool readRecords(std::ifstream& file, uint64_t count, std::vector<T>& records)
+    {
+        const size_t CHUNK = 4096;
+        for (uint64_t left = count; left > 0;)
+        {
+            size_t n = left < CHUNK ? static_cast<size_t>(left) : CHUNK;
+            size_t size = records.size();
+            records.resize(size + n);
+            if (!file.read(reinterpret_cast<char*>(records.data() + size), n * sizeof(T)))
+            {
+                return false;
+            }
+            left -= n;
+        }
+        return true;
+    }
+
+    // the recorder of SIMPLEALLOCATOR_RECORD and its file
+    SimpleWorkloadRecorder* environmentRecorder = nullptr;
+    const char* environmentPath = nullptr;
+
+    // write the environment's recorder out at exit (the recorder itself is
+    // never destroyed, so static objects freeing memory later are harmless)
+    void saveEnvironmentRecorder()
+    {
+        environmentRecorder->getWorkload().save(environmentPath);
+    }
+}
+
+bool SimpleWorkload::save(const char* path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    uint64_t streamCount = streams.size();
+    uint64_t opCount = ops.size();
+    file.write(WORKLOAD_MAGIC, sizeof(WORKLOAD_MAGIC));
+    file.write(reinterpret_cast<const char*>(&streamCount), sizeof(streamCount));
+    file.write(reinterpret_cast<const char*>(streams.data()), streams.size() * sizeof(SimpleWorkloadStream));
+    file.write(reinterpret_cast<const char*>(&opCount), sizeof(opCount));
+    file.write(reinterpret_cast<const char*>(ops.data()), ops.size() * sizeof(SimpleWorkloadOp));
+    return static_cast<bool>(file);
+}
+
+bool SimpleWorkload::load(const char* path, SimpleWorkload& workload)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(WORKLOAD_MAGIC)];
+    uint64_t streamCount = 0;
+    uint64_t opCount = 0;
+    SimpleWorkload loaded;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) != 0
+        || !file.read(reinterpret_cast<char*>(&streamCount), sizeof(streamCount))
+        || !readRecords(file, streamCount, loaded.streams)
+        || !file.read(reinterpret_cast<char*>(&opCount), sizeof(opCount))
+        || !readRecords(file, opCount, loaded.ops))
+    {
+        return false;
+    }
+    //every op must name a stream and a slot that exist
+    for (const SimpleWorkloadOp& op : loaded.ops)
+    {
+        if (op.stream >= loaded.streams.size() || op.slot >= loaded.streams[op.stream].slots)
+        {
+            return false;
+        }
+    }
+    workload = std::move(loaded);
+    return true;
+}
+
+SimpleWorkloadRecorder::SimpleWorkloadRecorder()
+{
+}
+
+unsigned SimpleWorkloadRecorder::addStream(size_t objectSize)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    SimpleWorkloadStream stream;
+    stream.objectSize = objectSize;
+    stream.slots = 0;
+    stream.reserved = 0;
+    workload_.streams.push_back(stream);
+    liveSlots_.emplace_back();
+    freeSlots_.emplace_back();
+    return static_cast<unsigned>(workload_.streams.size() - 1);
+}
+
+void SimpleWorkloadRecorder::recordAllocate(unsigned stream, const void* pObj)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    //reuse a slot given back, or open a new one
+    uint32_t slot = 0;
+    if (!freeSlots_[stream].empty())
+    {
+        slot = freeSlots_[stream].back();
+        freeSlots_[stream].pop_back();
+    }
+    else
+    {
+        slot = workload_.streams[stream].slots++;
+    }
+    liveSlots_[stream][pObj] = slot;
+    SimpleWorkloadOp op;
+    op.slot = slot;
+    op.stream = static_cast<uint16_t>(stream);
+    op.type = SimpleWorkloadOp::ALLOCATE;
+    op.reserved = 0;
+    workload_.ops.push_back(op);
+}
+
+void SimpleWorkloadRecorder::recordFree(unsigned stream, const void* pObj)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = liveSlots_[stream].find(pObj);
+    if (it == liveSlots_[stream].end())
+    {
+        return;
+    }
+    SimpleWorkloadOp op;
+    op.slot = it->second;
+    op.stream = static_cast<uint16_t>(stream);
+    op.type = SimpleWorkloadOp::FREE;
+    op.reserved = 0;
+    workload_.ops.push_back(op);
+    freeSlots_[stream].push_back(it->second);
+    liveSlots_[stream].erase(it);
+}
+
+SimpleWorkload SimpleWorkloadRecorder::getWorkload() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return workload_;
+}
+
+SimpleWorkloadRecorder* SimpleWorkloadRecorder::fromEnvironment()
+{
+    //looked up once, by the first allocator made
+    static bool looked = false;
+    static std::mutex lookupLock;
+    std::lock_guard<std::mutex> guard(lookupLock);
+    if (!looked)
+    {
+        looked = true;
+        environmentPath = std::getenv("SIMPLEALLOCATOR_RECORD");
+        if (environmentPath != nullptr && *environmentPath != '\0')
+        {
+            environmentRecorder = new SimpleWorkloadRecorder();
+            std::atexit(saveEnvironmentRecorder);
+        }
+    }
+    return environmentRecorder;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file SimpleWorkload.h
+ * @brief SimpleWorkload and SimpleWorkloadRecorder class definitions
+ *        A recorded sequence of allocate/free calls, and the recorder that
+ *        captures it from a run, so that the same calls can be replayed
+ *        against any allocator configuration (see replay.cpp)
+ *        - this header only uses the standard library, so that programs
+ *          with their own SimpleAllocator (BST, AVL) can record as well
+ * @date 16 Oct 2026
+ */
+
+#ifndef SIMPLEWORKLOAD_H
+#define SIMPLEWORKLOAD_H
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One recorded call, 8 bytes as stored in a workload file
+ * - blocks are named by slot rather than by address: a slot is taken by
+ *   an allocation and given back when the block is freed, so a replay
+ *   only needs as many slots as blocks were ever live at once
+ */
+struct SimpleWorkloadOp
+{
+    /**
+     * Call types
+     */
+    enum Type
+    {
+        ALLOCATE, // allocate a block into the slot
+        FREE, // free the block in the slot
+    };
+
+    uint32_t slot; // slot of the block
+    uint16_t stream; // allocator the call was made on
+    uint8_t type; // one of Type
+    uint8_t reserved; // zero
+};
+
+/**
+ * One allocator of a recorded run
+ */
+struct SimpleWorkloadStream
+{
+    uint64_t objectSize; // object size of the allocator
+    uint32_t slots; // slots its calls use
+    uint32_t reserved; // zero
+};
+
+/**
+ * A recorded run: its allocators and every call made on them, in order
+ */
+struct SimpleWorkload
+{
+    std::vector<SimpleWorkloadStream> streams; // allocators, by stream number
+    std::vector<SimpleWorkloadOp> ops; // calls, in the order they were made
+
+    /**
+     * Write the workload to a binary file (native byte order)
+     * @param path file to write
+     * @return false if the file could not be written
+     */
+    bool save(const char* path) const;
+
+    /**
+     * Read a workload written by save()
+     * @param path file to read
+     * @param workload receives the workload
+     * @return false if the file could not be read or is not a workload
+     */
+    static bool load(const char* path, SimpleWorkload& workload);
+};
+
+/**
+ * The SimpleWorkloadRecorder class
+ * - every allocator registers as a stream, then reports its successful
+ *   allocate and free calls; calls from several threads are serialized
+ *   in the order they took the recorder's lock
+ * - frees of blocks the recorder never saw allocated are not recorded
+ */
+class SimpleWorkloadRecorder {
+public:
+    /**
+     * Constructor, with nothing recorded
+     */
+    SimpleWorkloadRecorder();
+
+    /**
+     * Register an allocator
+     * @param objectSize object size of the allocator
+     * @return its stream number
+     */
+    unsigned addStream(size_t objectSize);
+
+    /**
+     * Record an allocation
+     * @param stream stream number of the allocator
+     * @param pObj the block handed out
+     */
+    void recordAllocate(unsigned stream, const void* pObj);
+
+    /**
+     * Record a free
+     * @param stream stream number of the allocator
+     * @param pObj the block given back
+     */
+    void recordFree(unsigned stream, const void* pObj);
+
+    /**
+     * Get what has been recorded so far
+     * @return the workload
+     */
+    SimpleWorkload getWorkload() const;
+
+    /**
+     * Get the recorder that every allocator of the process records into,
+     * if the SIMPLEALLOCATOR_RECORD environment variable names a file;
+     * the workload is written to that file at exit
+     * @return the recorder, or nullptr if recording is off
+     */
+    static SimpleWorkloadRecorder* fromEnvironment();
+
+private:
+    SimpleWorkload workload_; // what has been recorded
+    std::vector<std::unordered_map<const void*, uint32_t>> liveSlots_; // slot of every live block, by stream
+    std::vector<std::vector<uint32_t>> freeSlots_; // slots given back, by stream
+    mutable std::mutex lock_; // guards everything above
+
+    // Make private to prevent copy construction and assignment
+    SimpleWorkloadRecorder(const SimpleWorkloadRecorder&) = delete;
+    SimpleWorkloadRecorder& operator=(const SimpleWorkloadRecorder&) = delete;
+};
+
+#endif // SIMPLEWORKLOAD_H
@@ -0,0 +1,175 @@
+/**
+ * @file SizeClassAllocator.cpp
+ * @brief SizeClassAllocator class definition
+ *        Routes each request to the SimpleAllocator pool of its size class,
+ *        with a fallback to the system allocator for oversized requests
+ * @date 16 Oct 2026
+ */
+#include <cstdlib>
+#include <new>
+#include "SizeClassAllocator.h"
+
+namespace
+{
+    // object size of each class
+    const size_t CLASS_SIZES[SizeClassAllocator::NUM_SIZE_CLASSES] = { 16, 32, 64, 128, 256 };
+
+    // class of a request, indexed by (size + 15) / 16
+    const unsigned char CLASS_TABLE[SizeClassAllocator::MAX_CLASS_SIZE / 16 + 1] =
+    {
+        0, 0,               // 0 - 16
+        1,                  // 17 - 32
+        2, 2,               // 33 - 64
+        3, 3, 3, 3,         // 65 - 128
+        4, 4, 4, 4, 4, 4, 4, 4 // 129 - 256
+    };
+}
+
+SizeClassAllocator::SizeClassAllocator(size_t pageBytes, const SimpleAllocatorConfig& config)
+    : useCPPMemManager_(config.useCPPMemManager), oversizeAllocations_(0),
+      oversizeDeallocations_(0), oversizeBytes_(0)
+{
+    unsigned created = 0;
+    try
+    {
+        for (; created < NUM_SIZE_CLASSES; created++)
+        {
+            //every class page fits in pageBytes, so bigger classes get fewer objects
+            //(leaving room for the page link and footer, so the page does not
+            //spill over into the next power of two)
+            SimpleAllocatorConfig classConfig = config;
+            classConfig.maxObjectsPerPage = 0;
+            classConfig.objectsPerPage = SimpleAllocator::objectsPerSpan(CLASS_SIZES[created], config, pageBytes);
+            pools_[created] = new SimpleAllocator(CLASS_SIZES[created], classConfig);
+        }
+    }
+    catch (...)
+    {
+        //don't leak the pools made so far
+        while (created > 0)
+        {
+            delete pools_[--created];
+        }
+        throw;
+    }
+}
+
+SizeClassAllocator::~SizeClassAllocator()
+{
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        delete pools_[i];
+    }
+}
+
+unsigned SizeClassAllocator::classOf(size_t size)
+{
+    if (size > MAX_CLASS_SIZE)
+    {
+        return NUM_SIZE_CLASSES;
+    }
+    return CLASS_TABLE[(size + 15) / 16];
+}
+
+size_t SizeClassAllocator::classSize(unsigned sizeClass)
+{
+    return CLASS_SIZES[sizeClass];
+}
+
+void* SizeClassAllocator::allocate(size_t size, const char* pLabel)
+{
+    unsigned sizeClass = classOf(size);
+    if (sizeClass < NUM_SIZE_CLASSES)
+    {
+        return pools_[sizeClass]->allocate(pLabel);
+    }
+
+    //too big for any class, go to the system allocator
+    void* pObj = nullptr;
+    if (useCPPMemManager_) //if true use new
+    {
+        pObj = operator new(size, std::nothrow);
+    }
+    else //if false use malloc
+    {
+        pObj = std::malloc(size);
+    }
+    //exception handling
+    if (pObj == nullptr)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_NO_MEMORY,
+            "Memory allocation for an oversized object failed."
+        );
+    }
+    oversizeAllocations_.fetch_add(1, std::memory_order_relaxed);
+    oversizeBytes_.fetch_add(size, std::memory_order_relaxed);
+    return pObj;
+}
+
+void SizeClassAllocator::free(void* pObj, size_t size)
+{
+    unsigned sizeClass = classOf(size);
+    if (sizeClass < NUM_SIZE_CLASSES)
+    {
+        pools_[sizeClass]->free(pObj);
+        return;
+    }
+
+    //exception handling
+    if (pObj == nullptr)
+    {
+        throw SimpleAllocatorException(
+            SimpleAllocatorException::E_BAD_BOUNDARY,
+            "Error during free: not on a block boundary in page."
+        );
+    }
+    if (useCPPMemManager_) //if true use delete
+    {
+        operator delete(pObj);
+    }
+    else //if false use free
+    {
+        std::free(pObj);
+    }
+    oversizeDeallocations_.fetch_add(1, std::memory_order_relaxed);
+    oversizeBytes_.fetch_sub(size, std::memory_order_relaxed);
+}
+
+unsigned SizeClassAllocator::freeEmptyPages()
+{
+    unsigned released = 0;
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        released += pools_[i]->freeEmptyPages();
+    }
+    return released;
+}
+
+const SimpleAllocator* SizeClassAllocator::getPool(unsigned sizeClass) const
+{
+    return pools_[sizeClass];
+}
+
+SizeClassStats SizeClassAllocator::getStats() const
+{
+    SizeClassStats stats;
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        SimpleAllocatorStats classStats = pools_[i]->getStats();
+        stats.freeObjects += classStats.freeObjects;
+        stats.objectsInUse += classStats.objectsInUse;
+        stats.pagesInUse += classStats.pagesInUse;
+        stats.pageBytes += classStats.pageBytes;
+        stats.allocations += classStats.allocations;
+        stats.deallocations += classStats.deallocations;
+    }
+    unsigned oversizeAllocations = oversizeAllocations_.load(std::memory_order_relaxed);
+    unsigned oversizeDeallocations = oversizeDeallocations_.load(std::memory_order_relaxed);
+    stats.oversizeAllocations = oversizeAllocations;
+    stats.oversizeInUse = oversizeAllocations - oversizeDeallocations;
+    stats.oversizeBytes = oversizeBytes_.load(std::memory_order_relaxed);
+    stats.allocations += oversizeAllocations;
+    stats.deallocations += oversizeDeallocations;
+    return stats;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file SizeClassAllocator.h
+ * @brief SizeClassAllocator class definition
+ *        A front end that owns one SimpleAllocator per size class and
+ *        routes each request to the smallest class that fits, so that a
+ *        single allocator can serve objects of any size
+ * @date 16 Oct 2026
+ */
+
+#ifndef SIZECLASSALLOCATOR_H
+#define SIZECLASSALLOCATOR_H
+#include <atomic>
+#include "SimpleAllocator.h"
+
+// Defaults for SizeClassAllocator construction when client does not specify
+static const size_t DEFAULT_SLAB_PAGE_BYTES = 4096; // page size, for every class
+static const unsigned DEFAULT_SLAB_MAX_PAGES = 1 << 16; // max pages per class
+
+/**
+ * SizeClassAllocator statistics struct
+ * - totals over every size class, plus the oversized requests
+ */
+struct SizeClassStats
+{
+    /**
+     * Constructor
+     * - all params are initialized to 0
+     */
+    SizeClassStats() :
+        freeObjects(0),
+        objectsInUse(0),
+        pagesInUse(0),
+        pageBytes(0),
+        allocations(0),
+        deallocations(0),
+        oversizeInUse(0),
+        oversizeBytes(0),
+        oversizeAllocations(0) {}
+
+    unsigned freeObjects; // free blocks over all classes
+    unsigned objectsInUse; // blocks in use over all classes (not counting oversized)
+    unsigned pagesInUse; // pages over all classes
+    size_t pageBytes; // memory held in pages over all classes
+    unsigned allocations; // total number of allocations over lifetime (including oversized)
+    unsigned deallocations; // total number of deallocations over lifetime (including oversized)
+    unsigned oversizeInUse; // oversized objects currently in use
+    size_t oversizeBytes; // memory currently held by oversized objects
+    unsigned oversizeAllocations; // total number of oversized allocations over lifetime
+};
+
+/**
+ * The SizeClassAllocator class
+ * - size classes are 16, 32, 64, 128 and 256 bytes; a request goes to the
+ *   smallest class that holds it, through a small lookup table
+ * - requests bigger than the largest class fall back to operator new or
+ *   malloc (following config.useCPPMemManager)
+ * - free() takes the size that was allocated, like sized delete, so that
+ *   it is routed without looking the pointer up
+ * - thread safety follows config.isConcurrent, which every class pool shares
+ */
+class SizeClassAllocator {
+public:
+    static const unsigned NUM_SIZE_CLASSES = 5; // number of size classes
+    static const size_t MAX_CLASS_SIZE = 256; // largest size served from a pool
+
+    /**
+     * Constructor
+     * @param pageBytes size of a page, for every class; each class gets as
+     *        many blocks as fit (at least 1)
+     * @param config configuration for every class pool
+     *        (config.objectsPerPage and config.maxObjectsPerPage are ignored,
+     *        every page of a class has the same size)
+     * @throws SimpleAllocatorException if construction fails
+     */
+    SizeClassAllocator(size_t pageBytes = DEFAULT_SLAB_PAGE_BYTES,
+            const SimpleAllocatorConfig& config = SimpleAllocatorConfig(false,
+                    DEFAULT_OBJECTS_PER_PAGE, DEFAULT_SLAB_MAX_PAGES));
+
+    /**
+     * Destructor
+     * - oversized objects still in use are not released
+     */
+    ~SizeClassAllocator();
+
+    /**
+     * Allocate memory
+     * @param size number of bytes needed
+     * @param pLabel label for memory block (only for EXTERNAL_HEADER)
+     * @return pointer to allocated memory
+     * @throws SimpleAllocatorException E_NO_PAGE or E_NO_MEMORY
+     */
+    void* allocate(size_t size, const char* pLabel = 0);
+
+    /**
+     * Free (deallocate) memory
+     * @param pObj pointer to object to deallocate
+     * @param size the size it was allocated with
+     * @throws SimpleAllocatorException E_BAD_BOUNDARY or E_MULTIPLE_FREE
+     */
+    void free(void* pObj, size_t size);
+
+    /**
+     * Free the empty pages of every size class
+     * @return number of pages released
+     */
+    unsigned freeEmptyPages();
+
+    /**
+     * Find the size class of a request
+     * @param size number of bytes
+     * @return index of the class, or NUM_SIZE_CLASSES if size is oversized
+     */
+    static unsigned classOf(size_t size);
+
+    /**
+     * Get the object size of a size class
+     * @param sizeClass index of the class
+     * @return the object size
+     */
+    static size_t classSize(unsigned sizeClass);
+
+    /**
+     * Get the pool serving a size class
+     * @param sizeClass index of the class
+     * @return the pool
+     */
+    const SimpleAllocator* getPool(unsigned sizeClass) const;
+
+    /**
+     * Get statistics struct, summed over every size class
+     * @return statistics
+     */
+    SizeClassStats getStats() const;
+
+private:
+    SimpleAllocator* pools_[NUM_SIZE_CLASSES]; // one pool per size class
+    bool useCPPMemManager_; // operator new (or malloc) for oversized requests
+    std::atomic<unsigned> oversizeAllocations_; // oversized allocations over lifetime
+    std::atomic<unsigned> oversizeDeallocations_; // oversized deallocations over lifetime
+    std::atomic<size_t> oversizeBytes_; // bytes held by oversized objects
+
+    // Make private to prevent copy construction and assignment
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+};
+
+#endif // SIZECLASSALLOCATOR_H
@@ -0,0 +1,841 @@
+/**
+ * @file bench.cpp
+ * @brief Throughput benchmarks for SimpleAllocator.
+ *        Unlike test.cpp, the numbers printed here depend on the machine,
+ *        so there is no expected output to compare against.
+ *        Usage: ./bench [benchmark-number] (runs all benchmarks if omitted)
+ * @date 16 Oct 2026
+ */
+
+#include "SimpleAllocator.h"
+#include "FixedAllocator.h"
+#include "ShardedAllocator.h"
+#include "SimpleMemoryResource.h"
+#include "SimpleTrace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+// a typical small node, about the size of a BST node of ints
+struct Payload {
+  Payload *left;
+  Payload *right;
+  long long data;
+};
+
+/**
+ * Time a callable
+ * @param fn the work to time
+ * @return elapsed wall clock seconds
+ */
+template <typename Fn> double timeIt(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+/**
+ * Print one result line
+ * @param name name of the configuration
+ * @param ops number of allocate + free calls made
+ * @param seconds time taken
+ */
+void report(const std::string &name, double ops, double seconds) {
+  printf("  %-40s %8.2f Mops/s\n", name.c_str(), ops / seconds / 1e6);
+}
+
+/**
+ * Configuration used by the benchmarks: no header, no padding, no debug,
+ * big pages and no practical page limit
+ * @param concurrent true to switch on concurrent mode
+ * @param lockFree true to use the lock-free shared free list
+ * @param magazineSize blocks cached per thread
+ */
+SimpleAllocatorConfig benchConfig(bool concurrent = false, bool lockFree = false,
+                                  unsigned magazineSize = DEFAULT_MAGAZINE_SIZE) {
+  SimpleAllocatorConfig config(false, 1024, 4096,
+                               SimpleAllocatorConfig::HeaderBlockInfo(), 0, 0,
+                               false);
+  config.isConcurrent = concurrent;
+  config.isLockFree = lockFree;
+  config.magazineSize = magazineSize;
+  return config;
+}
+
+/**
+ * The per-thread workload: allocate a batch of blocks, then free them all
+ * @param alloc called to get a block
+ * @param dealloc called to return a block
+ * @param batch blocks held at a time
+ * @param rounds number of batches
+ */
+template <typename Alloc, typename Dealloc>
+void churn(Alloc alloc, Dealloc dealloc, unsigned batch, unsigned rounds) {
+  std::vector<void *> ptrs(batch);
+  for (unsigned r = 0; r < rounds; r++) {
+    for (unsigned i = 0; i < batch; i++)
+      ptrs[i] = alloc();
+    for (unsigned i = 0; i < batch; i++)
+      dealloc(ptrs[i]);
+  }
+}
+
+/**
+ * Run the churn workload on numThreads threads at once
+ * @return elapsed seconds
+ */
+template <typename Alloc, typename Dealloc>
+double churnThreads(unsigned numThreads, Alloc alloc, Dealloc dealloc,
+                    unsigned batch, unsigned rounds) {
+  return timeIt([&]() {
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; t++)
+      threads.emplace_back([&]() { churn(alloc, dealloc, batch, rounds); });
+    for (auto &thread : threads)
+      thread.join();
+  });
+}
+
+/**
+ * Compare the shared free list variants against the single-threaded path
+ * 1. the plain allocator on one thread (no locking at all)
+ * 2. the plain allocator behind a mutex, shared by all threads
+ * 3. concurrent mode with a mutex-guarded shared list, with and without
+ *    thread magazines
+ * 4. concurrent mode with the lock-free shared list, with and without
+ *    thread magazines
+ * @param numThreads number of threads for the shared configurations
+ */
+void sharedListBench(unsigned numThreads) {
+  const unsigned batch = 256, rounds = 4000;
+  double ops = 2.0 * batch * rounds;
+  cout << "Shared free list throughput, " << numThreads << " threads, "
+       << batch << " blocks x " << rounds << " rounds per thread" << endl;
+
+  {
+    SimpleAllocator allocator(sizeof(Payload), benchConfig());
+    double s = churnThreads(1, [&]() { return allocator.allocate(); },
+                            [&](void *p) { allocator.free(p); }, batch, rounds);
+    report("single-threaded (1 thread, no lock)", ops, s);
+  }
+  {
+    SimpleAllocator allocator(sizeof(Payload), benchConfig());
+    std::mutex m;
+    double s = churnThreads(
+        numThreads,
+        [&]() {
+          std::lock_guard<std::mutex> g(m);
+          return allocator.allocate();
+        },
+        [&](void *p) {
+          std::lock_guard<std::mutex> g(m);
+          allocator.free(p);
+        },
+        batch, rounds);
+    report("single-threaded behind a mutex", ops * numThreads, s);
+  }
+
+  struct Variant {
+    const char *name;
+    bool lockFree;
+    unsigned magazineSize;
+  } variants[] = {
+      {"concurrent, mutex list, no magazine", false, 0},
+      {"concurrent, mutex list, magazines", false, DEFAULT_MAGAZINE_SIZE},
+      {"concurrent, lock-free list, no magazine", true, 0},
+      {"concurrent, lock-free list, magazines", true, DEFAULT_MAGAZINE_SIZE},
+  };
+  for (const Variant &v : variants) {
+    SimpleAllocator allocator(sizeof(Payload),
+                              benchConfig(true, v.lockFree, v.magazineSize));
+    double s = churnThreads(numThreads, [&]() { return allocator.allocate(); },
+                            [&](void *p) { allocator.free(p); }, batch, rounds);
+    report(v.name, ops * numThreads, s);
+  }
+  cout << endl;
+}
+
+/**
+ * Compare the checked and unchecked (release fast path) policies
+ * - same layout, single thread, with operator new/delete for reference
+ */
+void checkPolicyBench() {
+  const unsigned batch = 256, rounds = 20000;
+  double ops = 2.0 * batch * rounds;
+  cout << "Checked vs unchecked policy, 1 thread, " << batch << " blocks x "
+       << rounds << " rounds" << endl;
+
+  {
+    double s = churnThreads(
+        1, []() { return static_cast<void *>(new Payload); },
+        [](void *p) { delete static_cast<Payload *>(p); }, batch, rounds);
+    report("operator new/delete", ops, s);
+  }
+
+  struct Variant {
+    const char *name;
+    SimpleAllocatorConfig::HeaderType header;
+    unsigned padBytes;
+    bool checked;
+  } variants[] = {
+      {"no header, no pad, checked", SimpleAllocatorConfig::NO_HEADER, 0, true},
+      {"no header, no pad, unchecked", SimpleAllocatorConfig::NO_HEADER, 0, false},
+      {"basic header, 4 pad bytes, checked", SimpleAllocatorConfig::BASIC_HEADER, 4, true},
+      {"basic header, 4 pad bytes, unchecked", SimpleAllocatorConfig::BASIC_HEADER, 4, false},
+  };
+  for (const Variant &v : variants) {
+    SimpleAllocatorConfig config(false, 1024, 4096,
+                                 SimpleAllocatorConfig::HeaderBlockInfo(v.header),
+                                 0, v.padBytes, false);
+    config.isChecked = v.checked;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    double s = churnThreads(1, [&]() { return allocator.allocate(); },
+                            [&](void *p) { allocator.free(p); }, batch, rounds);
+    report(v.name, ops, s);
+  }
+  cout << endl;
+}
+
+/**
+ * Compare allocateBatch/freeBatch against one call per block
+ * - single thread, checked and unchecked, then concurrent mode on
+ *   numThreads threads
+ * @param numThreads number of threads for the concurrent configuration
+ */
+void batchBench(unsigned numThreads) {
+  const unsigned batch = 256, rounds = 20000;
+  double ops = 2.0 * batch * rounds;
+  cout << "Batch vs single calls, " << batch << " blocks x " << rounds
+       << " rounds per thread" << endl;
+
+  struct Variant {
+    const char *name;
+    bool checked;
+    bool concurrent;
+  } variants[] = {
+      {"checked", true, false},
+      {"unchecked", false, false},
+      {"concurrent, magazines", true, true},
+  };
+  for (const Variant &v : variants) {
+    SimpleAllocatorConfig config = benchConfig(v.concurrent);
+    config.isChecked = v.checked;
+    unsigned threads = v.concurrent ? numThreads : 1;
+    {
+      SimpleAllocator allocator(sizeof(Payload), config);
+      double s = churnThreads(threads, [&]() { return allocator.allocate(); },
+                              [&](void *p) { allocator.free(p); }, batch, rounds);
+      report(std::string(v.name) + ", single calls", ops * threads, s);
+    }
+    {
+      SimpleAllocator allocator(sizeof(Payload), config);
+      double s = timeIt([&]() {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+          workers.emplace_back([&]() {
+            std::vector<void *> ptrs(batch);
+            for (unsigned r = 0; r < rounds; r++) {
+              allocator.allocateBatch(batch, ptrs.data());
+              allocator.freeBatch(batch, ptrs.data());
+            }
+          });
+        for (auto &worker : workers)
+          worker.join();
+      });
+      report(std::string(v.name) + ", batch calls", ops * threads, s);
+    }
+  }
+  cout << endl;
+}
+
+/**
+ * Time growing a pool with big pages while using few of the blocks
+ * - a fresh allocator per round, 16 blocks taken from each 64K-block page
+ * - checked mode signs the whole page up front, unchecked only touches
+ *   the blocks it hands out
+ */
+void growthBench() {
+  const unsigned perPage = 1 << 16, used = 16, rounds = 200;
+  double ops = 2.0 * used * rounds;
+  cout << "Page growth, " << perPage << " blocks per page, " << used
+       << " blocks used x " << rounds << " rounds" << endl;
+
+  for (bool checked : {true, false}) {
+    SimpleAllocatorConfig config(false, perPage, 4,
+                                 SimpleAllocatorConfig::HeaderBlockInfo(), 0,
+                                 0, false);
+    config.isChecked = checked;
+    double s = timeIt([&]() {
+      for (unsigned r = 0; r < rounds; r++) {
+        SimpleAllocator allocator(sizeof(Payload), config);
+        churn([&]() { return allocator.allocate(); },
+              [&](void *p) { allocator.free(p); }, used, 1);
+      }
+    });
+    report(checked ? "checked (eager signatures)" : "unchecked (lazy carving)",
+           ops, s);
+  }
+  cout << endl;
+}
+
+/**
+ * Fill a list, a map and an unordered_map, then erase everything again
+ * @param list the list to use
+ * @param map the map to use
+ * @param hash the unordered_map to use
+ * @param count elements put in each container
+ * @param rounds number of fill and erase rounds
+ */
+template <typename List, typename Map, typename Hash>
+void containerChurn(List &list, Map &map, Hash &hash, unsigned count,
+                    unsigned rounds) {
+  for (unsigned r = 0; r < rounds; r++) {
+    for (unsigned i = 0; i < count; i++) {
+      list.push_back(i);
+      map[i] = i;
+      hash[i] = i;
+    }
+    for (unsigned i = 0; i < count; i++) {
+      list.pop_front();
+      map.erase(i);
+      hash.erase(i);
+    }
+  }
+}
+
+/**
+ * Compare std containers with and without the pmr adapter
+ * - std::allocator, the pmr new/delete resource, the standard
+ *   unsynchronized pool resource and SimpleMemoryResource (checked and
+ *   unchecked pools), single thread
+ */
+void memoryResourceBench() {
+  const unsigned count = 1000, rounds = 500;
+  double ops = 2.0 * 3 * count * rounds;
+  cout << "std containers (list, map, unordered_map), " << count
+       << " elements x " << rounds << " rounds" << endl;
+
+  {
+    std::list<long long> list;
+    std::map<long long, long long> map;
+    std::unordered_map<long long, long long> hash;
+    double s = timeIt([&]() { containerChurn(list, map, hash, count, rounds); });
+    report("std::allocator", ops, s);
+  }
+
+  auto pmrRun = [&](const char *name, std::pmr::memory_resource *resource) {
+    std::pmr::list<long long> list(resource);
+    std::pmr::map<long long, long long> map(resource);
+    std::pmr::unordered_map<long long, long long> hash(resource);
+    double s = timeIt([&]() { containerChurn(list, map, hash, count, rounds); });
+    report(name, ops, s);
+  };
+  pmrRun("pmr new_delete_resource", std::pmr::new_delete_resource());
+  {
+    std::pmr::unsynchronized_pool_resource pool;
+    pmrRun("pmr unsynchronized_pool_resource", &pool);
+  }
+  for (bool checked : {true, false}) {
+    SimpleAllocatorConfig config(false, DEFAULT_OBJECTS_PER_PAGE,
+                                 DEFAULT_SLAB_MAX_PAGES);
+    config.isChecked = checked;
+    SimpleMemoryResource resource(std::pmr::new_delete_resource(),
+                                  DEFAULT_SLAB_PAGE_BYTES, config);
+    pmrRun(checked ? "SimpleMemoryResource, checked"
+                   : "SimpleMemoryResource, unchecked",
+           &resource);
+  }
+  cout << endl;
+}
+
+/**
+ * The main function
+ * @param argc number of command line arguments
+ * @param argv array of command line arguments
+ */
+/**
+ * Measure what the event trace costs
+ * - the same churn untraced and traced, on one thread and on numThreads
+ *   threads sharing a concurrent allocator
+ * - the last traced run is dumped to trace.bin for ./traceview
+ * @param numThreads number of threads for the concurrent runs
+ */
+void traceBench(unsigned numThreads) {
+  const unsigned batch = 256, rounds = 4000, traceEvents = 1 << 16;
+  double ops = 2.0 * batch * rounds;
+  cout << "Event trace overhead, " << batch << " blocks x " << rounds
+       << " rounds per thread, " << traceEvents << " events kept" << endl;
+
+  for (bool concurrent : {false, true}) {
+    unsigned threads = concurrent ? numThreads : 1;
+    for (unsigned events : {0u, traceEvents}) {
+      SimpleAllocatorConfig config = benchConfig(concurrent);
+      config.traceEvents = events;
+      SimpleAllocator allocator(sizeof(Payload), config);
+      double s = churnThreads(threads, [&]() { return allocator.allocate(); },
+                              [&](void *p) { allocator.free(p); }, batch,
+                              rounds);
+      std::string name = concurrent ? "concurrent, " : "single-threaded, ";
+      report(name + (events ? "traced" : "untraced"), ops * threads, s);
+      if (events && concurrent && allocator.dumpTrace("trace.bin"))
+        cout << "  (dumped to trace.bin, see make traceview)" << endl;
+    }
+  }
+  cout << endl;
+}
+
+/**
+ * Compare the two debug modes: patterns and poisoning (config.poisonMemory)
+ * - only an AddressSanitizer build poisons (make bench-asan), elsewhere the
+ *   poisoning configuration falls back to the patterns
+ */
+void poisonBench() {
+  const unsigned batch = 256, rounds = 20000;
+  double ops = 2.0 * batch * rounds;
+  cout << "Patterns vs poisoning, basic header, 16 pad bytes, 1 thread, "
+       << batch << " blocks x " << rounds << " rounds" << endl;
+
+  struct Variant {
+    const char *name;
+    bool checked;
+    bool poison;
+  } variants[] = {
+      {"checked, patterns", true, false},
+      {"checked, poisoning", true, true},
+      {"unchecked", false, false},
+  };
+  for (const Variant &v : variants) {
+    SimpleAllocatorConfig config(
+        false, 1024, 4096,
+        SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+        0, 16, false);
+    config.isChecked = v.checked;
+    config.poisonMemory = v.poison;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    double s = churnThreads(1, [&]() { return allocator.allocate(); },
+                            [&](void *p) { allocator.free(p); }, batch, rounds);
+    report(v.name, ops, s);
+    if (v.poison && !allocator.getConfig().poisonMemory)
+      cout << "  (no AddressSanitizer in this build, that was patterns)" << endl;
+  }
+  cout << endl;
+}
+
+// blocks reported by the leak dump benchmark's callback
+unsigned long long dumpedBlocks = 0;
+
+/**
+ * Callback for the leak dump benchmark, touching the block like a report
+ * would, without printing it
+ * @param block the block in use
+ * @param size its size
+ */
+void countBlock(const void *block, size_t size) {
+  dumpedBlocks += *static_cast<const unsigned char *>(block) + size;
+}
+
+/**
+ * Time dumpMemoryInUse over 4M blocks with one in eight still in use
+ * - checked mode reads the bitmaps it keeps, unchecked derives them from
+ *   the free list first
+ */
+void leakDumpBench() {
+  const unsigned blocks = 1 << 22, rounds = 10;
+  cout << "Leak dump, " << blocks << " blocks, 1 in 8 in use, " << rounds
+       << " dumps" << endl;
+
+  for (bool checked : {true, false}) {
+    SimpleAllocatorConfig config = benchConfig();
+    config.maxPages = UNLIMITED_PAGES;
+    config.isChecked = checked;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    std::vector<void *> ptrs(blocks);
+    for (unsigned i = 0; i < blocks; i++)
+      ptrs[i] = allocator.allocate();
+    for (unsigned i = 0; i < blocks; i++)
+      if (i % 8 != 0)
+        allocator.free(ptrs[i]);
+    unsigned found = 0;
+    double counted = timeIt([&]() {
+      for (unsigned r = 0; r < rounds; r++)
+        found += allocator.dumpMemoryInUse(nullptr);
+    });
+    double dumped = timeIt([&]() {
+      for (unsigned r = 0; r < rounds; r++)
+        found += allocator.dumpMemoryInUse(countBlock);
+    });
+    printf("  %-40s %8.2f ms counted, %8.2f ms dumped (%u blocks)\n",
+           checked ? "checked (kept bitmaps)" : "unchecked (derived bitmaps)",
+           counted * 1e3 / rounds, dumped * 1e3 / rounds,
+           found / (2 * rounds));
+  }
+  cout << endl;
+}
+
+/**
+ * Compare tearing down 1M blocks one free() at a time against reset()
+ * and releaseAll() (config.isArena)
+ */
+void arenaBench() {
+  const unsigned blocks = 1 << 20, rounds = 10;
+  double ops = 1.0 * blocks * rounds;
+  cout << "Arena teardown, " << blocks << " blocks x " << rounds
+       << " rounds (allocations and teardown timed)" << endl;
+
+  for (bool checked : {true, false}) {
+    for (unsigned way = 0; way < 3; way++) {
+      SimpleAllocatorConfig config = benchConfig();
+      config.maxPages = UNLIMITED_PAGES;
+      config.isChecked = checked;
+      config.isArena = way > 0;
+      SimpleAllocator allocator(sizeof(Payload), config);
+      std::vector<void *> ptrs(blocks);
+      double s = timeIt([&]() {
+        for (unsigned r = 0; r < rounds; r++) {
+          for (unsigned i = 0; i < blocks; i++)
+            ptrs[i] = allocator.allocate();
+          if (way == 0)
+            for (unsigned i = 0; i < blocks; i++)
+              allocator.free(ptrs[i]);
+          else if (way == 1)
+            allocator.reset();
+          else
+            allocator.releaseAll();
+        }
+      });
+      const char *names[] = {"free() each", "reset()", "releaseAll()"};
+      report(std::string(checked ? "checked, " : "unchecked, ") + names[way],
+             ops, s);
+    }
+  }
+  cout << endl;
+}
+
+/**
+ * A single-producer single-consumer ring of block pointers, so that the
+ * hand-off itself costs next to nothing next to the allocator
+ */
+struct HandOff {
+  static const unsigned SIZE = 1024;
+  void *slots[SIZE];
+  std::atomic<unsigned> head{0}; // next slot to read (consumer)
+  std::atomic<unsigned> tail{0}; // next slot to write (producer)
+
+  void push(void *p) {
+    unsigned t = tail.load(std::memory_order_relaxed);
+    while (t - head.load(std::memory_order_acquire) == SIZE)
+      std::this_thread::yield();
+    slots[t % SIZE] = p;
+    tail.store(t + 1, std::memory_order_release);
+  }
+
+  void *pop() {
+    unsigned h = head.load(std::memory_order_relaxed);
+    while (tail.load(std::memory_order_acquire) == h)
+      std::this_thread::yield();
+    void *p = slots[h % SIZE];
+    head.store(h + 1, std::memory_order_release);
+    return p;
+  }
+};
+
+/**
+ * Producer/consumer pairs: one thread of each pair allocates blocks and
+ * hands them over, the other frees them
+ * 1. the plain allocator behind a mutex
+ * 2. concurrent mode with magazines, where the consumer's magazine
+ *    overflows onto the shared list and the producer's refills from it
+ * 3. the same with remote frees, where the blocks go straight back to the
+ *    producer's queue
+ * 4. the lock-free shared list with magazines, for reference
+ * @param numPairs number of producer/consumer pairs
+ */
+void producerConsumerBench(unsigned numPairs) {
+  const unsigned blocks = 1 << 20;
+  double ops = 2.0 * blocks * numPairs;
+  cout << "Producer/consumer, " << numPairs << " pairs, " << blocks
+       << " blocks handed over per pair" << endl;
+
+  for (unsigned way = 0; way < 4; way++) {
+    SimpleAllocatorConfig config = benchConfig(way > 0, way == 3);
+    config.maxPages = UNLIMITED_PAGES;
+    config.remoteFrees = way == 2;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    std::mutex m;
+    std::vector<HandOff> rings(numPairs);
+    double s = timeIt([&]() {
+      std::vector<std::thread> threads;
+      for (unsigned pair = 0; pair < numPairs; pair++) {
+        HandOff &ring = rings[pair];
+        threads.emplace_back([&]() {
+          for (unsigned i = 0; i < blocks; i++) {
+            void *p = nullptr;
+            if (way == 0) {
+              std::lock_guard<std::mutex> g(m);
+              p = allocator.allocate();
+            } else
+              p = allocator.allocate();
+            ring.push(p);
+          }
+        });
+        threads.emplace_back([&]() {
+          for (unsigned i = 0; i < blocks; i++) {
+            void *p = ring.pop();
+            if (way == 0) {
+              std::lock_guard<std::mutex> g(m);
+              allocator.free(p);
+            } else
+              allocator.free(p);
+          }
+        });
+      }
+      for (auto &thread : threads)
+        thread.join();
+    });
+    const char *names[] = {"single-threaded behind a mutex",
+                           "concurrent, mutex list, magazines",
+                           "concurrent, magazines, remote frees",
+                           "concurrent, lock-free list, magazines"};
+    report(names[way], ops, s);
+  }
+  cout << endl;
+}
+
+/**
+ * Many short-lived threads, a few at a time: thread magazines against
+ * per-CPU shards
+ * - each thread churns its own blocks and exits; the page bytes held at
+ *   the end show how memory follows the threads or the CPUs
+ * @param numThreads threads running at once
+ */
+void shardBench(unsigned numThreads) {
+  const unsigned waves = 64, batch = 64, rounds = 500;
+  double ops = 2.0 * batch * rounds * numThreads * waves;
+  cout << "Short-lived threads, " << waves << " waves of " << numThreads
+       << " threads, " << batch << " blocks x " << rounds
+       << " rounds per thread" << endl;
+
+  auto runWaves = [&](auto alloc, auto dealloc) {
+    return timeIt([&]() {
+      for (unsigned w = 0; w < waves; w++)
+        churnThreads(numThreads, alloc, dealloc, batch, rounds);
+    });
+  };
+  auto reportBytes = [&](const std::string &name, double s, size_t bytes) {
+    printf("  %-40s %8.2f Mops/s %8zu KiB in pages\n", name.c_str(),
+           ops / s / 1e6, bytes / 1024);
+  };
+  {
+    SimpleAllocatorConfig config = benchConfig(true);
+    config.maxPages = UNLIMITED_PAGES;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    double s = runWaves([&]() { return allocator.allocate(); },
+                        [&](void *p) { allocator.free(p); });
+    reportBytes("concurrent, mutex list, magazines", s,
+                allocator.getStats().pageBytes);
+  }
+  {
+    SimpleAllocatorConfig config = benchConfig();
+    config.maxPages = UNLIMITED_PAGES;
+    ShardedAllocator allocator(sizeof(Payload), config);
+    double s = runWaves([&]() { return allocator.allocate(); },
+                        [&](void *p) { allocator.free(p); });
+    unsigned contended = 0;
+    for (unsigned i = 0; i < allocator.numShards(); i++)
+      contended += allocator.getShardStats(i).contended;
+    reportBytes("per-CPU shards (" + std::to_string(allocator.numShards()) +
+                    ", " + std::to_string(contended) + " contended)",
+                s, allocator.getStats().pageBytes);
+  }
+  cout << endl;
+}
+
+/**
+ * Churn a FixedAllocator on one thread
+ * @param name name of the configuration
+ * @param batch blocks held at a time
+ * @param rounds number of batches
+ */
+template <typename Fixed>
+void fixedChurn(const char *name, unsigned batch, unsigned rounds) {
+  Fixed allocator(4096);
+  double s = churnThreads(1, [&]() { return allocator.allocate(); },
+                          [&](void *p) { allocator.free(p); }, batch, rounds);
+  report(name, 2.0 * batch * rounds, s);
+}
+
+/**
+ * Compare the fixed-layout template against the runtime allocator
+ * - the layouts of checkPolicyBench, single thread: the runtime class reads
+ *   its layout from the config on every call, the template has it folded
+ *   into the code
+ */
+void fixedBench() {
+  const unsigned batch = 256, rounds = 20000;
+  double ops = 2.0 * batch * rounds;
+  cout << "Fixed vs runtime layout, 1 thread, " << batch << " blocks x "
+       << rounds << " rounds" << endl;
+
+  auto runtime = [&](const char *name, SimpleAllocatorConfig::HeaderType header,
+                     unsigned padBytes, bool checked) {
+    SimpleAllocatorConfig config(false, 1024, 4096,
+                                 SimpleAllocatorConfig::HeaderBlockInfo(header),
+                                 0, padBytes, false);
+    config.isChecked = checked;
+    SimpleAllocator allocator(sizeof(Payload), config);
+    double s = churnThreads(1, [&]() { return allocator.allocate(); },
+                            [&](void *p) { allocator.free(p); }, batch, rounds);
+    report(name, ops, s);
+  };
+  const SimpleAllocatorConfig::HeaderType none = SimpleAllocatorConfig::NO_HEADER;
+  const SimpleAllocatorConfig::HeaderType basic = SimpleAllocatorConfig::BASIC_HEADER;
+  runtime("runtime, no header, checked", none, 0, true);
+  fixedChurn<FixedAllocator<sizeof(Payload), 1024> >(
+      "fixed, no header, checked", batch, rounds);
+  runtime("runtime, no header, unchecked", none, 0, false);
+  fixedChurn<FixedAllocator<sizeof(Payload), 1024, none, 0, 0, false> >(
+      "fixed, no header, unchecked", batch, rounds);
+  runtime("runtime, basic header, 4 pad, checked", basic, 4, true);
+  fixedChurn<FixedAllocator<sizeof(Payload), 1024, basic, 4> >(
+      "fixed, basic header, 4 pad, checked", batch, rounds);
+  runtime("runtime, basic header, 4 pad, unchecked", basic, 4, false);
+  fixedChurn<FixedAllocator<sizeof(Payload), 1024, basic, 4, 0, false> >(
+      "fixed, basic header, 4 pad, unchecked", batch, rounds);
+  cout << endl;
+}
+
+// keeps the list walks from being optimized away
+volatile long long walkSink;
+
+/**
+ * Page-local free lists against one free list for all pages
+ * - the live blocks grow and shrink at random until the free blocks are
+ *   scattered over the pages, then a list is built from blocks allocated
+ *   one after the other and walked over and over (BST nodes made after
+ *   some churn are reached the same way)
+ * - the number of 4 KiB pages the list spans shows where the difference
+ *   comes from
+ */
+void pageLocalBench() {
+  const unsigned churnSteps = 4000000, maxLive = 1 << 18, nodes = 1 << 16,
+                 walks = 200;
+  double ops = 1.0 * nodes * walks;
+  cout << "Page-local free lists, " << churnSteps << " churn steps (up to "
+       << maxLive << " live), then " << walks << " walks of a " << nodes
+       << " node list" << endl;
+
+  for (bool pageLocal : {false, true}) {
+    SimpleAllocatorConfig config = benchConfig();
+    config.maxPages = UNLIMITED_PAGES;
+    config.isChecked = false;
+    config.pageLocalFrees = pageLocal;
+    SimpleAllocator allocator(sizeof(Payload), config);
+
+    std::vector<void *> live;
+    bool growing = true;
+    unsigned seed = 12345;
+    for (unsigned step = 0; step < churnSteps; step++) {
+      seed = seed * 1103515245 + 12345;
+      if (live.size() >= maxLive)
+        growing = false;
+      if (live.size() <= maxLive / 8)
+        growing = true;
+      if (live.empty() || ((seed >> 16) % 4 != 0) == growing) {
+        live.push_back(allocator.allocate());
+      } else {
+        size_t i = (seed >> 8) % live.size();
+        allocator.free(live[i]);
+        live[i] = live.back();
+        live.pop_back();
+      }
+    }
+
+    Payload *head = nullptr;
+    std::set<uintptr_t> pages;
+    for (unsigned i = 0; i < nodes; i++) {
+      Payload *node = static_cast<Payload *>(allocator.allocate());
+      node->left = head;
+      node->data = i;
+      head = node;
+      pages.insert(reinterpret_cast<uintptr_t>(node) / 4096);
+    }
+    long long sum = 0;
+    double s = timeIt([&]() {
+      for (unsigned w = 0; w < walks; w++)
+        for (Payload *node = head; node != nullptr; node = node->left)
+          sum += node->data;
+    });
+    for (Payload *node = head; node != nullptr;) {
+      Payload *next = node->left;
+      allocator.free(node);
+      node = next;
+    }
+    report(std::string(pageLocal ? "page-local" : "one free list") +
+               ", walk on " + std::to_string(pages.size()) + " 4K pages",
+           ops, s);
+    walkSink = sum;
+    for (void *p : live)
+      allocator.free(p);
+  }
+  cout << endl;
+}
+
+int main(int argc, char *argv[]) {
+  // benchmark number (0 runs them all)
+  int bench = 0;
+  if (argc > 1)
+    bench = atoi(argv[1]);
+
+  unsigned numThreads = std::thread::hardware_concurrency();
+  if (numThreads < 4)
+    numThreads = 4;
+
+  try {
+    if (bench == 0 || bench == 1)
+      sharedListBench(numThreads);
+    if (bench == 0 || bench == 2)
+      checkPolicyBench();
+    if (bench == 0 || bench == 3)
+      batchBench(numThreads);
+    if (bench == 0 || bench == 4)
+      growthBench();
+    if (bench == 0 || bench == 5)
+      memoryResourceBench();
+    if (bench == 0 || bench == 6)
+      traceBench(numThreads);
+    if (bench == 0 || bench == 7)
+      poisonBench();
+    if (bench == 0 || bench == 8)
+      leakDumpBench();
+    if (bench == 0 || bench == 9)
+      arenaBench();
+    if (bench == 0 || bench == 10)
+      producerConsumerBench(numThreads / 2);
+    if (bench == 0 || bench == 11)
+      shardBench(numThreads);
+    if (bench == 0 || bench == 12)
+      fixedBench();
+    if (bench == 0 || bench == 13)
+      pageLocalBench();
+  } catch (const SimpleAllocatorException &e) {
+    cout << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
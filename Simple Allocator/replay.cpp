@@ -0,0 +1,337 @@
+/**
+ * @file replay.cpp
+ * @brief Replays a recorded workload (see SimpleWorkload.h) against one
+ *        SimpleAllocator configuration, or against malloc or operator new,
+ *        and reports throughput, peak RSS and page counts.
+ *        Record a workload by running any program with
+ *        SIMPLEALLOCATOR_RECORD=<file>, e.g. the BST stress test:
+ *          (cd ../BST && make compile && SIMPLEALLOCATOR_RECORD=bst.work ./out 10)
+ *        Usage: ./replay <workload-file> [options]
+ *          --trace          the file is a trace dump (SimpleAllocator::dumpTrace)
+ *          --malloc, --new  replay against malloc/free or operator new/delete
+ *          --objects N      objectsPerPage
+ *          --pages N        maxPages (0 for no limit, the default)
+ *          --grow N         maxObjectsPerPage
+ *          --header T       none, basic, extended or external
+ *          --pad N          padBytesSize
+ *          --align N        alignmentBoundary
+ *          --unchecked      isChecked = false
+ *          --mmap           useMmap = true
+ *          --rounds N       timed replays (default 10)
+ *        One configuration per run, so that the peak RSS is its own.
+ * @date 16 Oct 2026
+ */
+
+#include "SimpleAllocator.h"
+#include "SimpleTrace.h"
+#include "SimpleWorkload.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Where the blocks of a replay come from
+ */
+enum Source { SIMPLE_SOURCE, MALLOC_SOURCE, NEW_SOURCE };
+
+/**
+ * Per-stream results of the measuring pass
+ */
+struct StreamResult {
+  unsigned peakPages;   // most pages in use at once
+  size_t peakPageBytes; // most page bytes at once
+  unsigned endPages;    // pages in use when the replay ends
+};
+
+/**
+ * Get the resident set size of the process right now
+ * @return resident KiB, or 0 where it cannot be read
+ */
+long currentRssKiB() {
+#if defined(__linux__)
+  long pages = 0, resident = 0;
+  FILE *statm = std::fopen("/proc/self/statm", "r");
+  if (statm == nullptr)
+    return 0;
+  if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+    resident = 0;
+  std::fclose(statm);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Get the peak resident set size of the process so far
+ * @return peak resident KiB, or 0 where it cannot be read
+ */
+long peakRssKiB() {
+#if defined(__APPLE__)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024; // bytes on macOS
+#elif defined(__unix__)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Turn a trace dump into a single-stream workload; blocks freed without
+ * having been seen allocated (the ring wrapped) are left out
+ * @param trace the trace
+ * @param workload receives the workload
+ */
+void workloadFromTrace(const SimpleTraceDump &trace, SimpleWorkload &workload) {
+  SimpleWorkloadRecorder recorder;
+  unsigned stream = recorder.addStream(static_cast<size_t>(trace.objectSize));
+  for (const SimpleTraceEvent &event : trace.events) {
+    const void *block = reinterpret_cast<const void *>(
+        static_cast<uintptr_t>(event.address));
+    if (event.type == SimpleTraceEvent::ALLOCATE)
+      recorder.recordAllocate(stream, block);
+    else if (event.type == SimpleTraceEvent::FREE)
+      recorder.recordFree(stream, block);
+  }
+  workload = recorder.getWorkload();
+}
+
+/**
+ * Replay the workload once
+ * @param workload the workload
+ * @param source where blocks come from
+ * @param config configuration of every allocator (SIMPLE_SOURCE)
+ * @param results receives the page counts per stream if not nullptr
+ *        (reading the stats after every call, so only for an untimed pass)
+ */
+void replay(const SimpleWorkload &workload, Source source,
+            const SimpleAllocatorConfig &config,
+            std::vector<StreamResult> *results) {
+  size_t numStreams = workload.streams.size();
+  std::vector<SimpleAllocator *> allocators(numStreams, nullptr);
+  std::vector<std::vector<void *>> slots(numStreams);
+  for (size_t s = 0; s < numStreams; s++) {
+    slots[s].assign(workload.streams[s].slots, nullptr);
+    if (source == SIMPLE_SOURCE)
+      allocators[s] = new SimpleAllocator(
+          static_cast<size_t>(workload.streams[s].objectSize), config);
+  }
+  if (results != nullptr) {
+    // an allocator may set up its first page before any call
+    results->assign(numStreams, StreamResult{0, 0, 0});
+    for (size_t s = 0; s < numStreams; s++) {
+      SimpleAllocatorStats stats = allocators[s]->getStats();
+      (*results)[s].peakPages = stats.pagesInUse;
+      (*results)[s].peakPageBytes = stats.pageBytes;
+    }
+  }
+
+  try {
+    for (const SimpleWorkloadOp &op : workload.ops) {
+      void *&slot = slots[op.stream][op.slot];
+      size_t objectSize = static_cast<size_t>(workload.streams[op.stream].objectSize);
+      if (op.type == SimpleWorkloadOp::ALLOCATE) {
+        if (source == SIMPLE_SOURCE)
+          slot = allocators[op.stream]->allocate();
+        else if (source == MALLOC_SOURCE)
+          slot = std::malloc(objectSize);
+        else
+          slot = operator new(objectSize);
+        // the client constructs its object
+        std::memset(slot, 0, objectSize);
+        if (results != nullptr) {
+          SimpleAllocatorStats stats = allocators[op.stream]->getStats();
+          StreamResult &result = (*results)[op.stream];
+          if (stats.pagesInUse > result.peakPages)
+            result.peakPages = stats.pagesInUse;
+          if (stats.pageBytes > result.peakPageBytes)
+            result.peakPageBytes = stats.pageBytes;
+        }
+      } else {
+        if (source == SIMPLE_SOURCE)
+          allocators[op.stream]->free(slot);
+        else if (source == MALLOC_SOURCE)
+          std::free(slot);
+        else
+          operator delete(slot);
+        slot = nullptr;
+      }
+    }
+  } catch (...) {
+    for (SimpleAllocator *allocator : allocators)
+      delete allocator;
+    throw;
+  }
+
+  // blocks the run never freed go with their allocators
+  for (size_t s = 0; s < numStreams; s++) {
+    if (results != nullptr)
+      (*results)[s].endPages = allocators[s]->getStats().pagesInUse;
+    if (source != SIMPLE_SOURCE)
+      for (void *p : slots[s]) {
+        if (source == MALLOC_SOURCE)
+          std::free(p);
+        else
+          operator delete(p);
+      }
+    delete allocators[s];
+  }
+}
+
+/**
+ * The main function
+ * @param argc number of command line arguments
+ * @param argv array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::printf("Usage: %s <workload-file> [--trace] [--malloc | --new] "
+                "[--objects N] [--pages N] [--grow N] [--header "
+                "none|basic|extended|external] [--pad N] [--align N] "
+                "[--unchecked] [--mmap] [--rounds N]\n",
+                argv[0]);
+    return 1;
+  }
+
+  // replays never run out of pages unless asked to
+  SimpleAllocatorConfig config(false, DEFAULT_OBJECTS_PER_PAGE, UNLIMITED_PAGES);
+  SimpleAllocatorConfig::HeaderType header = SimpleAllocatorConfig::NO_HEADER;
+  const char *headerName = "none";
+  Source source = SIMPLE_SOURCE;
+  bool isTrace = false;
+  unsigned rounds = 10;
+  for (int i = 2; i < argc; i++) {
+    std::string option = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : "";
+    if (option == "--trace")
+      isTrace = true;
+    else if (option == "--malloc")
+      source = MALLOC_SOURCE;
+    else if (option == "--new")
+      source = NEW_SOURCE;
+    else if (option == "--unchecked")
+      config.isChecked = false;
+    else if (option == "--mmap")
+      config.useMmap = true;
+    else if (option == "--objects" && ++i < argc)
+      config.objectsPerPage = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--pages" && ++i < argc)
+      config.maxPages = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--grow" && ++i < argc)
+      config.maxObjectsPerPage = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--pad" && ++i < argc)
+      config.padBytesSize = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--align" && ++i < argc)
+      config.alignmentBoundary = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--rounds" && ++i < argc)
+      rounds = static_cast<unsigned>(std::atoi(value));
+    else if (option == "--header" && ++i < argc) {
+      headerName = value;
+      if (std::strcmp(value, "basic") == 0)
+        header = SimpleAllocatorConfig::BASIC_HEADER;
+      else if (std::strcmp(value, "extended") == 0)
+        header = SimpleAllocatorConfig::EXTENDED_HEADER;
+      else if (std::strcmp(value, "external") == 0)
+        header = SimpleAllocatorConfig::EXTERNAL_HEADER;
+      else if (std::strcmp(value, "none") != 0) {
+        std::printf("Unknown header type %s\n", value);
+        return 1;
+      }
+    } else {
+      std::printf("Unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+  config.headerBlockInfo = SimpleAllocatorConfig::HeaderBlockInfo(header);
+  if (config.objectsPerPage == 0 || rounds == 0) {
+    std::printf("--objects and --rounds must be at least 1\n");
+    return 1;
+  }
+
+  SimpleWorkload workload;
+  if (isTrace) {
+    SimpleTraceDump trace;
+    if (!SimpleTrace::load(argv[1], trace)) {
+      std::printf("%s is not a trace dump\n", argv[1]);
+      return 1;
+    }
+    if (trace.recorded > trace.events.size())
+      std::printf("(the trace wrapped, only its last %zu events are replayed)\n",
+                  trace.events.size());
+    workloadFromTrace(trace, workload);
+  } else if (!SimpleWorkload::load(argv[1], workload)) {
+    std::printf("%s is not a workload file\n", argv[1]);
+    return 1;
+  }
+
+  unsigned allocations = 0;
+  for (const SimpleWorkloadOp &op : workload.ops)
+    if (op.type == SimpleWorkloadOp::ALLOCATE)
+      allocations++;
+  std::printf("workload: %zu calls (%u allocations, %zu frees) on %zu "
+              "allocators\n",
+              workload.ops.size(), allocations,
+              workload.ops.size() - allocations, workload.streams.size());
+  for (size_t s = 0; s < workload.streams.size(); s++)
+    std::printf("  stream %zu: objectSize %llu, at most %u live\n", s,
+                static_cast<unsigned long long>(workload.streams[s].objectSize),
+                workload.streams[s].slots);
+
+  if (source == MALLOC_SOURCE)
+    std::printf("source: malloc\n");
+  else if (source == NEW_SOURCE)
+    std::printf("source: operator new\n");
+  else
+    std::printf("source: SimpleAllocator, objectsPerPage %u, maxPages %u, "
+                "maxObjectsPerPage %u, header %s, pad %u, align %u, %s%s\n",
+                config.objectsPerPage, config.maxPages,
+                config.maxObjectsPerPage, headerName, config.padBytesSize,
+                config.alignmentBoundary,
+                config.isChecked ? "checked" : "unchecked",
+                config.useMmap ? ", mmap" : "");
+
+  long rssBefore = currentRssKiB();
+  try {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < rounds; r++)
+      replay(workload, source, config, nullptr);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("rounds: %u, %.3f s, %.2f Mops/s\n", rounds, elapsed.count(),
+                workload.ops.size() * rounds / elapsed.count() / 1e6);
+    std::printf("peak RSS: %ld KiB (%ld KiB before the replays)\n",
+                peakRssKiB(), rssBefore);
+
+    // one more, untimed, for the page counts
+    if (source == SIMPLE_SOURCE) {
+      std::vector<StreamResult> results;
+      replay(workload, source, config, &results);
+      for (size_t s = 0; s < results.size(); s++)
+        std::printf("  stream %zu: peak pages %u, peak page bytes %zu, "
+                    "pages at end %u\n",
+                    s, results[s].peakPages, results[s].peakPageBytes,
+                    results[s].endPages);
+    }
+  } catch (const SimpleAllocatorException &e) {
+    std::printf("replay failed: %s\n", e.what());
+    return 1;
+  } catch (const std::bad_alloc &) {
+    std::printf("replay failed: out of memory\n");
+    return 1;
+  }
+  return 0;
+}
@@ -7,14 +7,31 @@
  */
 
 #include "SimpleAllocator.h"
+#include "SizeClassAllocator.h"
+#include "ShardedAllocator.h"
+#include "FixedAllocator.h"
+#include "SimpleMemoryResource.h"
+#include "SimpleStdAllocator.h"
+#include "SimpleTrace.h"
+#include "SimpleWorkload.h"
 #include "prng.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <list>
+#include <map>
+#include <set>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using std::cout;
 using std::endl;
@@ -199,18 +216,17 @@ void dumpCallback(const void *block, size_t size) {
 /**
  * Check if there are leaks and dump them
  * @param allocator allocator to check
- * TODO: this is for future reference
  */
-//void checkAndDumpLeaks(const SimpleAllocator *allocator) {
-  //if (allocator->getStats().objectsInUse) {
-    //printf("Memory leaks detected!\n");
-    //printf("Dumping objects ->\n");
-    //unsigned leaks = allocator->dumpMemoryInUse(dumpCallback);
-    //printf("Total leaks: [%u]\n", leaks);
-  //} else {
-    //printf("No memory leaks detected.\n");
-  //}
-//}
+void checkAndDumpLeaks(const SimpleAllocator *allocator) {
+  if (allocator->getStats().objectsInUse) {
+    printf("Memory leaks detected!\n");
+    printf("Dumping objects ->\n");
+    unsigned leaks = allocator->dumpMemoryInUse(dumpCallback);
+    printf("Total leaks: [%u]\n", leaks);
+  } else {
+    printf("No memory leaks detected.\n");
+  }
+}
 
 /**
  * Callback function to print out the address and size of a block of memory
@@ -440,70 +456,2286 @@ void multiAllocFreeTest( SimpleAllocator* allocator, bool maskExternalHeaders =
  * @param numObjsToAllocate number of objects to allocate
  * @param numObjsToFree number of objects to free
  */
-void corruptionTest(SimpleAllocator* allocator) {
+void corruptionTest(SimpleAllocator* allocator) {
+  try {
+    // print a title of the test
+    cout << "Running corruptionTest with: " << endl;
+
+    // print the config
+    printConfig(allocator);
+    cout << endl;
+
+    // num objects to allocate
+    auto numObjsToAllocate = 8;
+
+    // init a ptrs array
+    void *ptrs[numObjsToAllocate];
+    
+    // allocate memory into the ptrs array
+    for (auto i = 0; i < numObjsToAllocate; i++) {
+      ptrs[i] = allocator->allocate();
+    }
+
+    // print the stats and dump the pages
+    cout << "After " << numObjsToAllocate << " allocations..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // fabricate some memory corruption in left pad bytes of a block
+    // 1. get the first byte of the first object
+    // 2. subtract the pad bytes from the address
+    // 3. set some pad bytes to 0xFF (no such signature in SimpleAllocator)
+    auto padBytes = allocator->getConfig().padBytesSize;
+    auto pByte = static_cast<unsigned char*>(ptrs[0]) - padBytes;
+    auto bytesToCorrupt = (padBytes > 3) ? 3 : padBytes;
+    for (unsigned i = 0; i < bytesToCorrupt; i++) {
+      *pByte++ = 0xFF;
+    }
+
+    // TODO: make an input arg to select whether to corrupt left or right
+    // fabricate another memory corruption in the right pad bytes of a block
+    // 1. get the first byte of the second object
+    // 2. add the object size to the address
+    // 3. set some pad bytes to 0xEE (the alignment signature)
+    auto objSize = allocator->getStats().objectSize;
+    pByte = static_cast<unsigned char*>(ptrs[1]) + objSize;
+    for (auto i = bytesToCorrupt; i < padBytes ; i++) {
+      *pByte++ = 0xEE;
+    }
+    
+    // print the stats and dump the pages
+    cout << "After some corruption..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // now try to free the corrupted blocks
+    // 1. free the first block
+    // 2. free the second block
+    // 3. let the exceptions show themselves
+    allocator->free(ptrs[0]);
+    allocator->free(ptrs[1]);
+
+    // print stats and dump the pages if no exception from above
+    // - the expected behavior is that the above will throw an exception
+    cout << "After " << "2" << " frees..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Hammer a concurrent allocator from several threads at once.
+ * 1. every thread repeatedly allocates a batch of objects, stamps each of
+ *    them with its own thread number, checks the stamps and frees them
+ * 2. a block handed out twice would show up as someone else's stamp
+ * 3. print the aggregated stats (only the counts that do not depend on
+ *    how the threads were scheduled)
+ *
+ * @param allocator an existing concurrent allocator to use
+ * @param numThreads number of threads
+ * @param numObjs number of objects each thread holds at a time
+ * @param rounds number of allocate+free rounds per thread
+ */
+void concurrentTest(SimpleAllocator* allocator, unsigned numThreads, unsigned numObjs, unsigned rounds) {
+  // print a title of the test
+  cout << "Running concurrentTest with " << numThreads << " threads, "
+       << numObjs << " objects, " << rounds << " rounds" << endl;
+  printConfig(allocator);
+  cout << endl;
+
+  std::vector<unsigned> clashes(numThreads, 0);
+  std::vector<unsigned> failures(numThreads, 0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < numThreads; t++) {
+    threads.emplace_back([=, &clashes, &failures]() {
+      std::vector<Student*> ptrs(numObjs);
+      for (unsigned r = 0; r < rounds; r++) {
+        try {
+          for (unsigned i = 0; i < numObjs; i++) {
+            ptrs[i] = static_cast<Student*>(allocator->allocate("stu"));
+            ptrs[i]->id = t;
+          }
+          std::this_thread::yield();
+          for (unsigned i = 0; i < numObjs; i++) {
+            if (ptrs[i]->id != t)
+              clashes[t]++;
+            allocator->free(ptrs[i]);
+          }
+        } catch (const SimpleAllocatorException &e) {
+          failures[t]++;
+          return;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  unsigned totalClashes = 0, totalFailures = 0;
+  for (unsigned t = 0; t < numThreads; t++) {
+    totalClashes += clashes[t];
+    totalFailures += failures[t];
+  }
+
+  SimpleAllocatorStats stats = allocator->getStats();
+  cout << "After all threads joined..." << endl;
+  cout << "objectsInUse: " << stats.objectsInUse;
+  cout << ", allocations: " << stats.allocations;
+  cout << ", frees: " << stats.deallocations << endl;
+  cout << "free + in use == capacity of pages: "
+       << (stats.freeObjects + stats.objectsInUse ==
+           stats.pagesInUse * allocator->getConfig().objectsPerPage)
+       << endl;
+  cout << "blocks handed out twice: " << totalClashes << endl;
+  cout << "threads that hit an exception: " << totalFailures << endl;
+}
+
+/**
+ * Test releasing empty pages, on demand and automatically
+ * 1. allocate 4 pages worth of objects
+ * 2. free every object on 2 of the pages and one on another page
+ * 3. call freeEmptyPages and check that exactly the 2 empty pages went away
+ * 4. allocate again so that a fresh page is needed
+ * 5. with a second allocator that keeps at most 1 empty page, free
+ *    everything and check that the other pages are released automatically
+ *
+ * @param allocator an existing allocator with 4 objects per page
+ */
+void emptyPagesTest(SimpleAllocator* allocator) {
+  try {
+    // print a title of the test
+    cout << "Running emptyPagesTest with: " << endl;
+    printConfig(allocator);
+    cout << endl;
+
+    // allocate 4 pages, blocks come out page by page
+    void *ptrs[16];
+    for (unsigned i = 0; i < 16; i++)
+      ptrs[i] = allocator->allocate();
+
+    // empty out the 2nd and 4th pages, and leave 1 hole in the 1st
+    for (unsigned i = 4; i < 8; i++)
+      allocator->free(ptrs[i]);
+    for (unsigned i = 12; i < 16; i++)
+      allocator->free(ptrs[i]);
+    allocator->free(ptrs[0]);
+    cout << "After 16 allocations and 9 frees..." << endl;
+    printStats(allocator);
+
+    // release the empty pages
+    unsigned released = allocator->freeEmptyPages();
+    cout << "freeEmptyPages released " << released << " pages" << endl;
+    cout << "pagesFreed: " << allocator->getStats().pagesFreed << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // nothing left to release
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+
+    // reuse the hole first, then grow again
+    for (unsigned i = 0; i < 5; i++)
+      ptrs[i] = allocator->allocate();
+    cout << "After 5 more allocations..." << endl;
+    printStats(allocator);
+
+    // a second allocator that keeps at most 1 empty page around
+    SimpleAllocatorConfig config = allocator->getConfig();
+    config.maxEmptyPages = 1;
+    SimpleAllocator autoAllocator(allocator->getStats().objectSize, config);
+    cout << "With maxEmptyPages: " << config.maxEmptyPages << endl;
+    for (unsigned i = 0; i < 12; i++)
+      ptrs[i] = autoAllocator.allocate();
+    cout << "After 12 allocations..." << endl;
+    printStats(&autoAllocator);
+    for (unsigned i = 0; i < 12; i++)
+      autoAllocator.free(ptrs[i]);
+    cout << "After 12 frees..." << endl;
+    cout << "pagesFreed: " << autoAllocator.getStats().pagesFreed << endl;
+    printStats(&autoAllocator);
+    dumpPages(&autoAllocator, 32);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Try to free a pointer and report the exception (if any)
+ * @param allocator allocator to free with
+ * @param p pointer to free
+ * @param what description of the pointer
+ */
+void tryFree(SimpleAllocator* allocator, void* p, const char* what) {
+  try {
+    allocator->free(p);
+    cout << "free(" << what << "): ok" << endl;
+  } catch (const SimpleAllocatorException &e) {
+    cout << "free(" << what << "): ";
+    if (e.code() == SimpleAllocatorException::E_BAD_BOUNDARY)
+      cout << "E_BAD_BOUNDARY ";
+    else if (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE)
+      cout << "E_MULTIPLE_FREE ";
+    if (SHOW_EXCEPTIONS)
+      cout << e.what();
+    cout << endl;
+  }
+}
+
+/**
+ * Test that bad frees are caught, across a large number of pages
+ * 1. fill every page of the allocator
+ * 2. free every other object in random order
+ * 3. free some of them again, and free pointers that are not block starts
+ * 4. free the rest and check the stats add up
+ * 5. free the only live block of a fresh allocator twice, with free() and
+ *    with freeBatch()
+ *
+ * @param allocator an existing allocator to use
+ */
+void badFreeTest(SimpleAllocator* allocator) {
+  // print a title of the test
+  cout << "Running badFreeTest with: " << endl;
+  printConfig(allocator);
+  cout << endl;
+
+  // fill every page
+  unsigned numObjs = allocator->getConfig().objectsPerPage *
+                     allocator->getConfig().maxPages;
+  std::vector<void*> ptrs(numObjs);
+  for (unsigned i = 0; i < numObjs; i++)
+    ptrs[i] = allocator->allocate();
+  cout << "After " << numObjs << " allocations..." << endl;
+  printStats(allocator);
+
+  // free every other object, in random order
+  shuffle(ptrs.data(), numObjs);
+  for (unsigned i = 0; i < numObjs; i += 2)
+    allocator->free(ptrs[i]);
+  cout << "After " << numObjs / 2 << " frees..." << endl;
+  printStats(allocator);
+
+  // frees that must be rejected
+  int onStack = 0;
+  tryFree(allocator, ptrs[0], "freed block");
+  tryFree(allocator, ptrs[numObjs - 2], "another freed block");
+  tryFree(allocator, static_cast<char*>(ptrs[1]) + 1, "inside a block");
+  tryFree(allocator, static_cast<char*>(ptrs[1]) - 1, "in front of a block");
+  tryFree(allocator, const_cast<void*>(allocator->getPageList()), "page start");
+  tryFree(allocator, &onStack, "stack variable");
+  cout << endl;
+  cout << "After rejected frees..." << endl;
+  printStats(allocator);
+
+  // the remaining frees are fine
+  for (unsigned i = 1; i < numObjs; i += 2)
+    allocator->free(ptrs[i]);
+  cout << "After " << numObjs / 2 << " more frees..." << endl;
+  printStats(allocator);
+  cout << endl;
+
+  // a double free is a double free even when nothing else is in use
+  SimpleAllocator single(allocator->getStats().objectSize, allocator->getConfig());
+  void* only = single.allocate();
+  single.free(only);
+  tryFree(&single, only, "only block, again");
+  try {
+    single.freeBatch(1, &only);
+    cout << "freeBatch(only block, again): ok" << endl;
+  } catch (const SimpleAllocatorException &e) {
+    cout << "freeBatch(only block, again): "
+         << (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+         << endl;
+  }
+}
+
+/**
+ * Test the batch allocate/free calls
+ * 1. allocate a batch bigger than the free list, so part of it is carved
+ *    straight out of a new page
+ * 2. free part of it in one batch
+ * 3. free batches that must be rejected as a whole (a freed block, a
+ *    block listed twice), and a batch that does not fit in the pages left
+ * 4. free the rest in one batch and release the empty pages
+ *
+ * @param allocator an existing allocator with 4 objects per page
+ */
+void batchTest(SimpleAllocator* allocator) {
+  try {
+    // print a title of the test
+    cout << "Running batchTest with: " << endl;
+    printConfig(allocator);
+    cout << endl;
+
+    // 4 blocks from the free list and 2 from a new page
+    void *ptrs[9];
+    allocator->allocateBatch(6, ptrs);
+    cout << "After a batch of 6 allocations..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // give back the middle of the batch
+    allocator->freeBatch(3, ptrs + 2);
+    cout << "After a batch of 3 frees..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+    void *freed = ptrs[2];
+    ptrs[2] = ptrs[5];
+
+    // batches that must be rejected without freeing anything
+    void *bad[3] = {ptrs[0], ptrs[1], freed};
+    try {
+      allocator->freeBatch(3, bad);
+      cout << "freeBatch(with a freed block): ok" << endl;
+    } catch (const SimpleAllocatorException &e) {
+      cout << "freeBatch(with a freed block): "
+           << (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+           << endl;
+    }
+    bad[2] = ptrs[0];
+    try {
+      allocator->freeBatch(3, bad);
+      cout << "freeBatch(with a block twice): ok" << endl;
+    } catch (const SimpleAllocatorException &e) {
+      cout << "freeBatch(with a block twice): "
+           << (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+           << endl;
+    }
+    void *tooMany[16];
+    try {
+      allocator->allocateBatch(16, tooMany);
+      cout << "allocateBatch(16): ok" << endl;
+    } catch (const SimpleAllocatorException &e) {
+      cout << "allocateBatch(16): "
+           << (e.code() == SimpleAllocatorException::E_NO_PAGE ? "E_NO_PAGE" : "other")
+           << endl;
+    }
+    cout << "After rejected batches..." << endl;
+    printStats(allocator);
+
+    // the freed blocks come back first, the rest is carved from new pages
+    allocator->allocateBatch(6, ptrs + 3);
+    cout << "After a batch of 6 allocations..." << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+
+    // free everything at once, then drop the empty pages
+    allocator->freeBatch(9, ptrs);
+    cout << "After a batch of 9 frees..." << endl;
+    printStats(allocator);
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+    printStats(allocator);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Print the global stats of a size-class allocator, then each class
+ * @param stats global stats to print
+ * @param allocator allocator to print the classes of
+ */
+void printSizeClassStats(const SizeClassStats &stats,
+                         const SizeClassAllocator *allocator) {
+  cout << "pagesInUse: " << stats.pagesInUse;
+  cout << ", pageBytes: " << stats.pageBytes;
+  cout << ", objectsInUse: " << stats.objectsInUse;
+  cout << ", freeObjects: " << stats.freeObjects;
+  cout << ", allocations: " << stats.allocations;
+  cout << ", frees: " << stats.deallocations << endl;
+  cout << "oversizeInUse: " << stats.oversizeInUse;
+  cout << ", oversizeBytes: " << stats.oversizeBytes;
+  cout << ", oversizeAllocations: " << stats.oversizeAllocations << endl;
+  for (unsigned i = 0; i < SizeClassAllocator::NUM_SIZE_CLASSES; i++) {
+    SimpleAllocatorStats classStats = allocator->getPool(i)->getStats();
+    cout << "  class " << SizeClassAllocator::classSize(i)
+         << ": pagesInUse: " << classStats.pagesInUse
+         << ", objectsInUse: " << classStats.objectsInUse
+         << ", allocations: " << classStats.allocations << endl;
+  }
+  cout << endl;
+}
+
+/**
+ * Print the global stats of a size-class allocator, then each class
+ * @param allocator allocator to print stats about
+ */
+void printSizeClassStats(const SizeClassAllocator *allocator) {
+  printSizeClassStats(allocator->getStats(), allocator);
+}
+
+/**
+ * Test the size-class front end
+ * 1. check which class each size is routed to
+ * 2. allocate objects of mixed sizes, some of them oversized
+ * 3. free half of them and check the global and per-class stats
+ * 4. free the rest and release the empty pages
+ */
+void sizeClassTest() {
+  try {
+    SizeClassAllocator allocator;
+    cout << "Running sizeClassTest with: " << endl;
+    for (unsigned i = 0; i < SizeClassAllocator::NUM_SIZE_CLASSES; i++)
+      cout << "class " << SizeClassAllocator::classSize(i) << ": objectsPerPage: "
+           << allocator.getPool(i)->getConfig().objectsPerPage << ", pageSize: "
+           << allocator.getPool(i)->getStats().pageSize << endl;
+    cout << endl;
+
+    // routing
+    size_t sizes[] = {1, 8, 16, 17, 32, 33, 100, 128, 129, 256, 257, 1000};
+    const unsigned numSizes = sizeof(sizes) / sizeof(sizes[0]);
+    for (unsigned i = 0; i < numSizes; i++) {
+      unsigned sizeClass = SizeClassAllocator::classOf(sizes[i]);
+      cout << "size " << sizes[i] << " -> ";
+      if (sizeClass < SizeClassAllocator::NUM_SIZE_CLASSES)
+        cout << "class " << SizeClassAllocator::classSize(sizeClass) << endl;
+      else
+        cout << "oversized" << endl;
+    }
+    cout << endl;
+
+    // 100 objects of each size, written to end to end
+    const unsigned perSize = 100;
+    std::vector<void *> ptrs(numSizes * perSize);
+    for (unsigned i = 0; i < numSizes * perSize; i++) {
+      ptrs[i] = allocator.allocate(sizes[i % numSizes]);
+      memset(ptrs[i], 0x55, sizes[i % numSizes]);
+    }
+    cout << "After " << numSizes * perSize << " allocations..." << endl;
+    printSizeClassStats(&allocator);
+
+    for (unsigned i = 0; i < numSizes * perSize; i += 2)
+      allocator.free(ptrs[i], sizes[i % numSizes]);
+    cout << "After " << numSizes * perSize / 2 << " frees..." << endl;
+    printSizeClassStats(&allocator);
+
+    for (unsigned i = 1; i < numSizes * perSize; i += 2)
+      allocator.free(ptrs[i], sizes[i % numSizes]);
+    cout << "After " << numSizes * perSize / 2 << " more frees..." << endl;
+    printSizeClassStats(&allocator);
+
+    cout << "freeEmptyPages released " << allocator.freeEmptyPages()
+         << " pages" << endl;
+    printSizeClassStats(&allocator);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test that blocks are aligned to the alignment boundary
+ * 1. print the alignment bytes computed for the layout
+ * 2. allocate every object and check each one is on the boundary
+ * 3. dump the pages to show the alignment signature
+ * 4. do the same with a 64 byte boundary and no header
+ *
+ * @param allocator an existing allocator with an alignment boundary
+ */
+void alignmentTest(SimpleAllocator* allocator) {
+  try {
+    // print a title of the test
+    cout << "Running alignmentTest with: " << endl;
+    printConfig(allocator);
+    cout << "alignBytes: " << allocator->getStats().alignBytes
+         << ", overheadBytes: " << allocator->getStats().overheadBytes << endl;
+    cout << endl;
+
+    unsigned numObjs = allocator->getConfig().objectsPerPage *
+                       allocator->getConfig().maxPages;
+    unsigned boundary = allocator->getConfig().alignmentBoundary;
+    std::vector<void*> ptrs(numObjs);
+    unsigned misaligned = 0;
+    for (unsigned i = 0; i < numObjs; i++) {
+      ptrs[i] = allocator->allocate();
+      if (reinterpret_cast<uintptr_t>(ptrs[i]) % boundary != 0)
+        misaligned++;
+    }
+    cout << "After " << numObjs << " allocations, " << misaligned
+         << " misaligned" << endl;
+    printStats(allocator);
+    dumpPages(allocator, 32);
+    for (unsigned i = 0; i < numObjs; i++)
+      allocator->free(ptrs[i]);
+
+    // cache line aligned blocks, no header
+    SimpleAllocatorConfig config(false, 4, 2,
+        SimpleAllocatorConfig::HeaderBlockInfo(), 64, 0, true);
+    SimpleAllocator lineAllocator(sizeof(Student), config);
+    cout << "With: " << endl;
+    printConfig(&lineAllocator);
+    cout << "alignBytes: " << lineAllocator.getStats().alignBytes
+         << ", overheadBytes: " << lineAllocator.getStats().overheadBytes << endl;
+    misaligned = 0;
+    for (unsigned i = 0; i < 8; i++) {
+      ptrs[i] = lineAllocator.allocate();
+      if (reinterpret_cast<uintptr_t>(ptrs[i]) % 64 != 0)
+        misaligned++;
+    }
+    cout << "After 8 allocations, " << misaligned << " misaligned" << endl;
+    printStats(&lineAllocator);
+    for (unsigned i = 0; i < 8; i++)
+      lineAllocator.free(ptrs[i]);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Get the external header info of an allocated block
+ * @param allocator allocator the block came from (with EXTERNAL_HEADER)
+ * @param p the block
+ * @return the block's info
+ */
+const MemBlockInfo *blockInfo(const SimpleAllocator *allocator, void *p) {
+  const char *header = static_cast<char *>(p) -
+                       allocator->getConfig().padBytesSize -
+                       allocator->getConfig().headerBlockInfo.size;
+  return *reinterpret_cast<MemBlockInfo *const *>(header);
+}
+
+/**
+ * Test that equal labels are stored once
+ * 1. allocate blocks with the same label, each time from a fresh string
+ * 2. check they all share one stored copy, and that a different label
+ *    gets its own
+ * 3. free and reallocate, the stored labels are reused
+ *
+ * @param allocator an existing allocator with EXTERNAL_HEADER
+ */
+void labelTest(SimpleAllocator *allocator) {
+  try {
+    // print a title of the test
+    cout << "Running labelTest with: " << endl;
+    printConfig(allocator);
+    cout << endl;
+
+    // like BST::makeNode, but the label never has the same address twice
+    void *ptrs[8];
+    for (unsigned i = 0; i < 6; i++)
+      ptrs[i] = allocator->allocate(std::string("NodeLabel").c_str());
+    ptrs[6] = allocator->allocate(std::string("EdgeLabel").c_str());
+    ptrs[7] = allocator->allocate();
+    cout << "After 8 allocations..." << endl;
+    printStats(allocator);
+    dumpPagesWithExtHdrs(allocator, 32);
+
+    unsigned shared = 0;
+    for (unsigned i = 1; i < 6; i++)
+      if (blockInfo(allocator, ptrs[i])->pLabel == blockInfo(allocator, ptrs[0])->pLabel)
+        shared++;
+    cout << "blocks sharing the first label: " << shared << " of 5" << endl;
+    cout << "different label shared: "
+         << (blockInfo(allocator, ptrs[6])->pLabel == blockInfo(allocator, ptrs[0])->pLabel ? "yes" : "no")
+         << endl;
+    cout << "no label: " << (blockInfo(allocator, ptrs[7])->pLabel ? "stored" : "null")
+         << endl;
+    cout << endl;
+
+    // free and allocate again with the first label
+    const char *first = blockInfo(allocator, ptrs[0])->pLabel;
+    for (unsigned i = 0; i < 8; i++)
+      allocator->free(ptrs[i]);
+    ptrs[0] = allocator->allocate(std::string("NodeLabel").c_str());
+    cout << "After 8 frees and 1 allocation..." << endl;
+    printStats(allocator);
+    cout << "reused the stored label: "
+         << (blockInfo(allocator, ptrs[0])->pLabel == first ? "yes" : "no") << endl;
+    allocator->free(ptrs[0]);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test pages that grow geometrically, with no page limit
+ * 1. allocate far more objects than fit on the first page, printing the
+ *    pages and page bytes as the pages double in size up to the ceiling
+ * 2. free pointers that must be rejected, on the bigger pages
+ * 3. free everything and release the empty pages
+ * 4. allocate and free one batch that spans several new pages
+ *
+ * @param allocator an existing allocator with growing pages and no page limit
+ */
+void growthTest(SimpleAllocator* allocator) {
+  try {
+    // print a title of the test
+    cout << "Running growthTest with: " << endl;
+    printConfig(allocator);
+    cout << "maxObjectsPerPage:" << allocator->getConfig().maxObjectsPerPage
+         << endl;
+    cout << endl;
+
+    // a new page every time the previous one fills up
+    const unsigned numObjs = 1000;
+    const unsigned checkpoints[] = {1, 2, 3, 6, 7, 14, 15, 62, 63, 94, 95, numObjs};
+    std::vector<void*> ptrs(numObjs);
+    unsigned next = 0;
+    for (unsigned i = 0; i < numObjs; i++) {
+      ptrs[i] = allocator->allocate();
+      if (i + 1 == checkpoints[next]) {
+        SimpleAllocatorStats stats = allocator->getStats();
+        cout << "After " << i + 1 << " allocations: pagesInUse: "
+             << stats.pagesInUse << ", pageBytes: " << stats.pageBytes
+             << endl;
+        next++;
+      }
+    }
+    cout << endl;
+    printStats(allocator);
+
+    // frees that must be rejected
+    int onStack = 0;
+    allocator->free(ptrs[500]);
+    tryFree(allocator, ptrs[500], "freed block");
+    tryFree(allocator, static_cast<char*>(ptrs[999]) + 1, "inside a block");
+    tryFree(allocator, &onStack, "stack variable");
+    cout << endl;
+
+    // free the rest and let the pages go
+    for (unsigned i = 0; i < numObjs; i++)
+      if (i != 500)
+        allocator->free(ptrs[i]);
+    cout << "After " << numObjs << " frees..." << endl;
+    printStats(allocator);
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+    cout << "pageBytes: " << allocator->getStats().pageBytes << endl;
+    printStats(allocator);
+
+    // new pages keep the size they had grown to
+    allocator->allocateBatch(100, ptrs.data());
+    cout << "After a batch of 100 allocations..." << endl;
+    cout << "pageBytes: " << allocator->getStats().pageBytes << endl;
+    printStats(allocator);
+    allocator->freeBatch(100, ptrs.data());
+    cout << "After a batch of 100 frees..." << endl;
+    printStats(allocator);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test the pmr memory resource over the size-class pools
+ * 1. check which requests are routed to a pool and which go upstream,
+ *    and that every block meets its alignment
+ * 2. fill a pmr list, map and unordered_map, whose nodes come from the
+ *    pools while the bucket arrays go upstream
+ * 3. erase half of each, then destroy the containers
+ */
+void memoryResourceTest() {
+  try {
+    SimpleMemoryResource resource;
+    cout << "Running memoryResourceTest with: " << endl;
+    cout << "alignment: " << resource.getAlignment() << endl;
+    cout << endl;
+
+    // routing, and the alignment of what comes back
+    struct Request {
+      size_t bytes;
+      size_t alignment;
+    } requests[] = {{8, 8}, {24, 8}, {48, 16}, {256, 16}, {257, 8}, {32, 32}, {32, 64}};
+    for (const Request &r : requests) {
+      void *p = resource.allocate(r.bytes, r.alignment);
+      cout << "allocate(" << r.bytes << ", " << r.alignment << ") -> ";
+      if (resource.isPooled(r.bytes, r.alignment))
+        cout << "class "
+             << SizeClassAllocator::classSize(SizeClassAllocator::classOf(r.bytes));
+      else
+        cout << "upstream";
+      cout << ", aligned: "
+           << (reinterpret_cast<uintptr_t>(p) % r.alignment == 0 ? "yes" : "no")
+           << endl;
+      resource.deallocate(p, r.bytes, r.alignment);
+    }
+    cout << endl;
+
+    {
+      std::pmr::list<int> list(&resource);
+      std::pmr::map<int, int> map(&resource);
+      std::pmr::unordered_map<int, int> hash(&resource);
+      for (int i = 0; i < 100; i++) {
+        list.push_back(i);
+        map[i] = i;
+        hash[i] = i;
+      }
+      cout << "After 100 inserts into a list, a map and an unordered_map..."
+           << endl;
+      printSizeClassStats(resource.getStats(), &resource.getPools());
+
+      for (int i = 0; i < 100; i += 2) {
+        list.pop_front();
+        map.erase(i);
+        hash.erase(i);
+      }
+      cout << "After 50 erases from each..." << endl;
+      printSizeClassStats(resource.getStats(), &resource.getPools());
+    }
+    cout << "After the containers are destroyed..." << endl;
+    printSizeClassStats(resource.getStats(), &resource.getPools());
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Print every pool of a pool set
+ * @param pools pool set to print
+ */
+void printPoolSet(const SimplePoolSet &pools) {
+  for (const SimpleAllocator *pool : pools.getPools()) {
+    SimpleAllocatorStats stats = pool->getStats();
+    cout << "  pool " << stats.objectSize << " (align "
+         << pool->getConfig().alignmentBoundary
+         << "): pagesInUse: " << stats.pagesInUse
+         << ", objectsInUse: " << stats.objectsInUse
+         << ", allocations: " << stats.allocations << endl;
+  }
+  cout << endl;
+}
+
+/**
+ * Test the standard allocator adapter with node-based containers
+ * 1. rebind an allocator and check that the copies compare equal
+ * 2. fill a set, a map, a list and a vector that share one pool set; the
+ *    nodes of the same size share a pool, the vector's buffer and the
+ *    over-aligned type go to operator new
+ * 3. copy, assign and erase, then destroy the containers and release
+ *    the empty pages
+ */
+void stdAllocatorTest() {
+  try {
+    SimpleAllocatorConfig config = SimplePoolSet::defaultConfig();
+    config.isConcurrent = false;
+    SimplePoolSet pools(config);
+    cout << "Running stdAllocatorTest with: " << endl;
+    cout << "objectsPerPage:" << config.objectsPerPage
+         << ", maxObjectsPerPage:" << config.maxObjectsPerPage
+         << ", maxPages:" << config.maxPages << endl;
+    cout << endl;
+
+    // rebinding keeps the pool set, and picks the pool of the new size
+    SimpleStdAllocator<int> intAlloc(pools);
+    SimpleStdAllocator<Student> studentAlloc(intAlloc);
+    cout << "rebound allocators equal: "
+         << (intAlloc == studentAlloc ? "yes" : "no") << endl;
+    cout << "pool of int: " << intAlloc.getPool()->getStats().objectSize
+         << ", pool of Student: "
+         << studentAlloc.getPool()->getStats().objectSize << endl;
+    cout << endl;
+
+    struct alignas(64) Wide {
+      char bytes[64];
+    };
+    {
+      std::set<int, std::less<int>, SimpleStdAllocator<int>> set(pools);
+      std::map<int, long long, std::less<int>,
+               SimpleStdAllocator<std::pair<const int, long long>>>
+          map(pools);
+      std::list<Student, SimpleStdAllocator<Student>> list(pools);
+      std::vector<int, SimpleStdAllocator<int>> vector(pools);
+      std::list<Wide, SimpleStdAllocator<Wide>> wide(pools);
+      for (int i = 0; i < 200; i++) {
+        set.insert(i);
+        map[i] = i;
+        list.push_back(Student());
+        vector.push_back(i);
+      }
+      for (int i = 0; i < 10; i++)
+        wide.push_back(Wide());
+      cout << "After 200 inserts into a set, a map, a list and a vector..."
+           << endl;
+      printPoolSet(pools);
+
+      // a copy draws from the same pools, assignment keeps them
+      std::set<int, std::less<int>, SimpleStdAllocator<int>> copy(set);
+      cout << "copy shares the pool set: "
+           << (copy.get_allocator() == set.get_allocator() ? "yes" : "no")
+           << endl;
+      for (int i = 0; i < 200; i += 2) {
+        set.erase(i);
+        map.erase(i);
+        list.pop_front();
+      }
+      set = copy;
+      cout << "After a copy, 100 erases from each and an assignment..."
+           << endl;
+      printPoolSet(pools);
+    }
+    cout << "After the containers are destroyed..." << endl;
+    printPoolSet(pools);
+    cout << "freeEmptyPages released " << pools.freeEmptyPages() << " pages"
+         << endl;
+    printPoolSet(pools);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Print the events of a trace, with blocks shown as page and block index
+ * (pages numbered in the order they appear) so the output does not
+ * depend on real addresses or timings
+ * @param trace the trace to print
+ */
+void printTrace(const SimpleTraceDump &trace) {
+  static const char *const TYPES[] = {"ALLOCATE", "FREE", "NEW_PAGE",
+                                      "FREE_PAGE"};
+  std::vector<uint64_t> pages;
+  std::vector<uint64_t> ends;
+  for (const SimpleTraceEvent &event : trace.events) {
+    cout << "  " << TYPES[event.type] << " thread " << unsigned(event.thread);
+    if (event.type == SimpleTraceEvent::NEW_PAGE ||
+        event.type == SimpleTraceEvent::FREE_PAGE) {
+      if (event.type == SimpleTraceEvent::NEW_PAGE) {
+        pages.push_back(event.address);
+        ends.push_back(event.address + trace.firstBlockOffset +
+                       event.value * trace.blockStride);
+      }
+      size_t page = std::find(pages.begin(), pages.end(), event.address) -
+                    pages.begin();
+      cout << " page " << page << " objects " << event.value << endl;
+      continue;
+    }
+    // the page whose blocks span the address
+    size_t page = pages.size();
+    for (size_t i = 0; i < pages.size(); i++)
+      if (event.address >= pages[i] && event.address < ends[i])
+        page = i;
+    if (page < pages.size())
+      cout << " page " << page << " block "
+           << (event.address - pages[page] - trace.firstBlockOffset) /
+                  trace.blockStride;
+    else
+      cout << " page ?";
+    if (event.labelId != 0)
+      cout << " label " << trace.labels[event.labelId];
+    cout << endl;
+  }
+  cout << endl;
+}
+
+/**
+ * Test the event trace
+ * 1. allocate (one at a time and in a batch) with labels, free, and
+ *    release an empty page, printing every event recorded
+ * 2. dump the trace to a file and load it back
+ * 3. overflow a small ring, which keeps only the latest events
+ *
+ * @param allocator an existing allocator with tracing on and 4 objects a page
+ */
+void traceTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running traceTest with: " << endl;
+    printConfig(allocator);
+    cout << "traceEvents:" << allocator->getConfig().traceEvents << endl;
+    cout << endl;
+
+    const char *labels[] = {"alpha", "beta"};
+    void *ptrs[8];
+    for (unsigned i = 0; i < 5; i++)
+      ptrs[i] = allocator->allocate(labels[i % 2]);
+    allocator->allocateBatch(3, ptrs + 5, "gamma");
+    for (unsigned i = 0; i < 4; i++)
+      allocator->free(ptrs[i]);
+    allocator->freeBatch(2, ptrs + 4);
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+    printStats(allocator);
+
+    const SimpleTrace *trace = allocator->getTrace();
+    SimpleTraceDump events = trace->snapshot();
+    cout << "Recorded " << trace->getRecorded() << " events of "
+         << trace->getCapacity() << ":" << endl;
+    printTrace(events);
+
+    // round trip through a dump file
+    const char *path = "trace23.bin";
+    SimpleTraceDump loaded;
+    bool dumped = allocator->dumpTrace(path);
+    bool read = SimpleTrace::load(path, loaded);
+    std::remove(path);
+    bool same = loaded.events.size() == events.events.size() &&
+                loaded.labels == events.labels &&
+                loaded.blockStride == events.blockStride &&
+                std::memcmp(loaded.events.data(), events.events.data(),
+                            events.events.size() * sizeof(SimpleTraceEvent)) ==
+                    0;
+    cout << "dumped: " << (dumped ? "yes" : "no")
+         << ", loaded: " << (read ? "yes" : "no") << ", " << loaded.events.size()
+         << " events, " << loaded.labels.size() - 1
+         << " labels, same as the trace: " << (same ? "yes" : "no") << endl;
+    cout << "load of a missing file: "
+         << (SimpleTrace::load(path, loaded) ? "yes" : "no") << endl;
+    cout << endl;
+
+    // a ring of 8 keeps the last 8 of 21 events
+    SimpleAllocatorConfig config(false, 16, 1);
+    config.traceEvents = 8;
+    SimpleAllocator small(sizeof(Student), config);
+    SimpleAllocator untraced(sizeof(Student), SimpleAllocatorConfig());
+    for (unsigned i = 0; i < 8; i++)
+      ptrs[i] = small.allocate();
+    for (unsigned i = 0; i < 8; i++)
+      small.free(ptrs[i]);
+    ptrs[0] = small.allocate();
+    ptrs[1] = small.allocate();
+    small.free(ptrs[0]);
+    small.free(ptrs[1]);
+    SimpleTraceDump wrapped = small.getTrace()->snapshot();
+    cout << "Small ring recorded " << wrapped.recorded << " events, kept "
+         << wrapped.events.size() << ":" << endl;
+    printTrace(wrapped);
+    cout << "untraced allocator has a trace: "
+         << (untraced.getTrace() != nullptr ? "yes" : "no")
+         << ", dumps: " << (untraced.dumpTrace(path) ? "yes" : "no") << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Print the calls of a workload, one stream at a time
+ * @param workload the workload
+ */
+void printWorkload(const SimpleWorkload &workload) {
+  for (size_t s = 0; s < workload.streams.size(); s++) {
+    cout << "  stream " << s << " (objectSize " << workload.streams[s].objectSize
+         << ", " << workload.streams[s].slots << " slots):";
+    for (const SimpleWorkloadOp &op : workload.ops)
+      if (op.stream == s)
+        cout << (op.type == SimpleWorkloadOp::ALLOCATE ? " +" : " -")
+             << op.slot;
+    cout << endl;
+  }
+}
+
+/**
+ * Record the calls made on two allocators, write them to a file, read
+ * them back and replay them on fresh allocators
+ * @param allocator allocator to record (Student sized)
+ */
+void workloadTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running workloadTest with: " << endl;
+    printConfig(allocator);
+    cout << endl;
+
+    SimpleWorkloadRecorder recorder;
+    SimpleAllocator employees(sizeof(Employee), allocator->getConfig());
+    allocator->setRecorder(&recorder);
+    employees.setRecorder(&recorder);
+
+    // slots are given back by frees and taken again by allocations
+    void *ptrs[8];
+    for (unsigned i = 0; i < 6; i++)
+      ptrs[i] = allocator->allocate();
+    void *employee = employees.allocate();
+    allocator->free(ptrs[1]);
+    allocator->free(ptrs[4]);
+    ptrs[1] = allocator->allocate();
+    allocator->allocateBatch(2, ptrs + 6);
+    tryFree(allocator, static_cast<char *>(ptrs[0]) + 1, "a bad boundary");
+    // a rejected batch frees nothing, so nothing of it is recorded
+    void *twice[2] = {ptrs[2], ptrs[2]};
+    try {
+      allocator->freeBatch(2, twice);
+      cout << "freeBatch(with a block twice): ok" << endl;
+    } catch (const SimpleAllocatorException &e) {
+      cout << "freeBatch(with a block twice): "
+           << (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+           << endl;
+    }
+    allocator->freeBatch(2, ptrs + 6);
+    employees.free(employee);
+    allocator->free(ptrs[0]);
+
+    // calls after this are not recorded
+    allocator->setRecorder(nullptr);
+    employees.setRecorder(nullptr);
+    allocator->free(ptrs[1]);
+    printStats(allocator);
+
+    SimpleWorkload workload = recorder.getWorkload();
+    cout << "Recorded " << workload.ops.size() << " calls on "
+         << workload.streams.size() << " allocators:" << endl;
+    printWorkload(workload);
+
+    // round trip through a file
+    const char *path = "workload24.bin";
+    SimpleWorkload loaded;
+    bool saved = workload.save(path);
+    bool read = SimpleWorkload::load(path, loaded);
+    std::remove(path);
+    bool same = loaded.streams.size() == workload.streams.size() &&
+                loaded.ops.size() == workload.ops.size() &&
+                std::memcmp(loaded.ops.data(), workload.ops.data(),
+                            workload.ops.size() * sizeof(SimpleWorkloadOp)) == 0;
+    cout << "saved: " << (saved ? "yes" : "no")
+         << ", loaded: " << (read ? "yes" : "no")
+         << ", same as the recording: " << (same ? "yes" : "no") << endl;
+    cout << "load of a missing file: "
+         << (SimpleWorkload::load(path, loaded) ? "yes" : "no") << endl;
+    cout << endl;
+
+    // replay on one fresh allocator per stream, as replay.cpp does
+    std::vector<SimpleAllocator *> allocators;
+    std::vector<std::vector<void *>> slots;
+    for (const SimpleWorkloadStream &stream : loaded.streams) {
+      allocators.push_back(new SimpleAllocator(
+          static_cast<size_t>(stream.objectSize), allocator->getConfig()));
+      slots.push_back(std::vector<void *>(stream.slots, nullptr));
+    }
+    for (const SimpleWorkloadOp &op : loaded.ops) {
+      if (op.type == SimpleWorkloadOp::ALLOCATE)
+        slots[op.stream][op.slot] = allocators[op.stream]->allocate();
+      else
+        allocators[op.stream]->free(slots[op.stream][op.slot]);
+    }
+    cout << "Replayed on fresh allocators:" << endl;
+    for (size_t s = 0; s < allocators.size(); s++) {
+      cout << "stream " << s << ": ";
+      printStats(allocators[s]);
+      // the block the run never freed goes with its allocator
+      delete allocators[s];
+    }
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Check that a range of bytes is guarded: poisoned when the allocator
+ * poisons, otherwise filled with the pattern
+ * @param allocator the allocator
+ * @param p first byte
+ * @param size number of bytes
+ * @param pattern pattern expected without poisoning
+ * @return true if every byte is guarded
+ */
+bool isGuarded(const SimpleAllocator *allocator, const void *p, size_t size,
+               unsigned char pattern) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(p);
+  for (size_t i = 0; i < size; i++) {
+    bool guarded = allocator->getConfig().poisonMemory
+                       ? SimpleAllocator::isPoisoned(bytes + i)
+                       : bytes[i] == pattern;
+    if (!guarded)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Test the poisoning debug mode; in a build without AddressSanitizer or
+ * Valgrind the allocator falls back to the patterns, and the test checks
+ * those instead, so the output is the same either way
+ * - the layout may differ (poisoned data is 8-byte aligned), so only the
+ *   counts are printed
+ * @param allocator allocator to test (pads, config.poisonMemory)
+ */
+void poisonTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running poisonTest" << endl;
+    unsigned pad = allocator->getConfig().padBytesSize;
+    size_t size = allocator->getStats().objectSize;
+
+    Student *students[6];
+    for (unsigned i = 0; i < 6; i++) {
+      students[i] = static_cast<Student *>(allocator->allocate());
+      students[i]->age = 20 + i;
+      students[i]->gpa = 3.0f;
+      students[i]->year = 2;
+    }
+    unsigned char *p = reinterpret_cast<unsigned char *>(students[0]);
+    cout << "pads of an allocated block guarded: "
+         << (isGuarded(allocator, p - pad, pad, SimpleAllocator::PAD_PATTERN) &&
+                     isGuarded(allocator, p + size, pad,
+                               SimpleAllocator::PAD_PATTERN)
+                 ? "yes"
+                 : "no")
+         << endl;
+    bool addressable = true;
+    for (size_t i = 0; i < size; i++)
+      addressable = addressable && !SimpleAllocator::isPoisoned(p + i);
+    cout << "data of an allocated block addressable: "
+         << (addressable ? "yes" : "no") << endl;
+
+    // the free list link stays addressable, the rest of the block does not
+    allocator->free(students[0]);
+    cout << "freed block guarded past its link: "
+         << (isGuarded(allocator, p + sizeof(void *), size - sizeof(void *),
+                       SimpleAllocator::FREED_PATTERN)
+                 ? "yes"
+                 : "no")
+         << endl;
+
+    // bad frees are still caught without touching the block
+    tryFree(allocator, students[0], "a freed block");
+    tryFree(allocator, p + 1, "a bad boundary");
+
+    // a block handed out again is usable all over
+    students[0] = static_cast<Student *>(allocator->allocate());
+    students[0]->age = 30;
+    cout << "reallocated block intact: "
+         << (students[0]->age == 30 && students[1]->age == 21 &&
+                     students[5]->age == 25
+                 ? "yes"
+                 : "no")
+         << endl;
+
+    void *batch[4];
+    allocator->allocateBatch(4, batch);
+    allocator->freeBatch(4, batch);
+    for (unsigned i = 0; i < 6; i++)
+      allocator->free(students[i]);
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+    printStats(allocator);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Find which of a set of blocks a pointer is
+ * @param blocks the blocks
+ * @param count number of blocks
+ * @param p the pointer
+ * @return its index, or count if it is none of them
+ */
+unsigned blockIndex(void *const *blocks, unsigned count, const void *p) {
+  unsigned i = 0;
+  while (i < count && blocks[i] != p)
+    i++;
+  return i;
+}
+
+/**
+ * Try a free that may throw on a block leaving the quarantine
+ * @param allocator the allocator
+ * @param p block to free
+ * @param what description to print
+ */
+void tryQuarantinedFree(SimpleAllocator *allocator, void *p, const char *what) {
+  try {
+    allocator->free(p);
+    cout << "free(" << what << "): ok" << endl;
+  } catch (const SimpleAllocatorException &e) {
+    cout << "free(" << what << "): ";
+    if (e.code() == SimpleAllocatorException::E_CORRUPTED_BLOCK)
+      cout << "E_CORRUPTED_BLOCK ";
+    else if (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE)
+      cout << "E_MULTIPLE_FREE ";
+    if (SHOW_EXCEPTIONS)
+      cout << e.what();
+    cout << endl;
+  }
+}
+
+/**
+ * Print the stats that show the quarantine
+ * @param allocator the allocator
+ */
+void printQuarantineStats(const SimpleAllocator *allocator) {
+  SimpleAllocatorStats stats = allocator->getStats();
+  cout << "quarantined: " << stats.quarantinedObjects
+       << ", freeObjects: " << stats.freeObjects
+       << ", objectsInUse: " << stats.objectsInUse
+       << ", pagesInUse: " << stats.pagesInUse << endl;
+}
+
+/**
+ * Test the quarantine of freed blocks
+ * 1. freed blocks are handed out again oldest first, only once more than
+ *    quarantineBytes of them are held back
+ * 2. a block written after it was freed is reported when it leaves
+ * 3. at the page limit, quarantined blocks are used before giving up
+ * 4. the unchecked path quarantines (and validates) the same way
+ * @param allocator allocator to test (4 objects per page, 3 pages,
+ *        2 blocks of quarantine)
+ */
+void quarantineTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running quarantineTest with: " << endl;
+    printConfig(allocator);
+    cout << "quarantineBytes:" << allocator->getConfig().quarantineBytes
+         << endl;
+    cout << endl;
+
+    void *blocks[13];
+    for (unsigned i = 0; i < 4; i++)
+      blocks[i] = allocator->allocate();
+    allocator->free(blocks[0]);
+    allocator->free(blocks[1]);
+    cout << "freed 0 and 1: ";
+    printQuarantineStats(allocator);
+    allocator->free(blocks[2]);
+    cout << "freed 2: ";
+    printQuarantineStats(allocator);
+    void *p = allocator->allocate();
+    cout << "allocate() hands out block " << blockIndex(blocks, 4, p)
+         << ", the oldest freed" << endl;
+    blocks[0] = p;
+
+    // a write after free is found once the block leaves
+    static_cast<Student *>(blocks[1])->age = 99; // any byte will do
+    tryQuarantinedFree(allocator, blocks[0], "0, letting 1 out");
+    tryQuarantinedFree(allocator, blocks[2], "2 again, in quarantine");
+    printQuarantineStats(allocator);
+    cout << endl;
+
+    // fill every page, the quarantined blocks come back last
+    allocator->free(blocks[3]);
+    unsigned allocated = 0;
+    try {
+      for (; allocated < 13; allocated++)
+        blocks[allocated] = allocator->allocate();
+    } catch (const SimpleAllocatorException &e) {
+      if (e.code() == SimpleAllocatorException::E_NO_PAGE)
+        cout << "E_NO_PAGE after ";
+    }
+    cout << allocated << " blocks, up to the page limit" << endl;
+    printQuarantineStats(allocator);
+    allocator->freeBatch(4, blocks);
+    cout << "freeBatch(4): ";
+    printQuarantineStats(allocator);
+    allocator->allocateBatch(3, blocks);
+    cout << "allocateBatch(3) at the limit: ";
+    printQuarantineStats(allocator);
+    for (unsigned i = 0; i < 3; i++)
+      allocator->free(blocks[i]);
+    for (unsigned i = 4; i < allocated; i++)
+      allocator->free(blocks[i]);
+    cout << "flushQuarantine let " << allocator->flushQuarantine()
+         << " blocks out" << endl;
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
+    printStats(allocator);
+
+    // the unchecked path fills the pattern itself
+    SimpleAllocatorConfig config = allocator->getConfig();
+    config.isChecked = false;
+    SimpleAllocator unchecked(sizeof(Student), config);
+    for (unsigned i = 0; i < 4; i++)
+      blocks[i] = unchecked.allocate();
+    unchecked.free(blocks[0]);
+    unchecked.free(blocks[1]);
+    static_cast<Student *>(blocks[0])->gpa = 1.5f; // any byte will do
+    tryQuarantinedFree(&unchecked, blocks[2], "2 unchecked, letting 0 out");
+    p = unchecked.allocate();
+    cout << "unchecked allocate() hands out block " << blockIndex(blocks, 4, p)
+         << endl;
+    printQuarantineStats(&unchecked);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test the leak dump (dumpMemoryInUse)
+ * 1. every header type, checked and unchecked, reports the same blocks:
+ *    allocated ones, whether carved fresh or recycled, but not the free,
+ *    quarantined or never carved ones
+ * 2. concurrent mode reports them too, once the magazines are handed back
+ * 3. a page of 200 blocks spans several bitmap words
+ */
+void leakDumpTest() {
+  try {
+    const SimpleAllocatorConfig::HeaderType types[] = {
+        SimpleAllocatorConfig::NO_HEADER, SimpleAllocatorConfig::BASIC_HEADER,
+        SimpleAllocatorConfig::EXTENDED_HEADER,
+        SimpleAllocatorConfig::EXTERNAL_HEADER};
+    const char *names[] = {"NONE", "BASIC", "EXTENDED", "EXTERNAL"};
+    for (unsigned t = 0; t < 4; t++) {
+      for (int checked = 1; checked >= 0; checked--) {
+        SimpleAllocatorConfig config(
+            false, 4, 3, SimpleAllocatorConfig::HeaderBlockInfo(types[t], 0, 2),
+            0, 2, true);
+        config.isChecked = checked == 1;
+        config.quarantineBytes = sizeof(Student);
+        SimpleAllocator allocator(sizeof(Student), config);
+        cout << names[t] << (checked ? ", checked:" : ", unchecked:") << endl;
+
+        // 7 blocks over 2 pages, 3 freed (1 in the quarantine), 1 reused
+        void *blocks[7];
+        for (unsigned i = 0; i < 7; i++) {
+          blocks[i] = allocator.allocate("leak");
+          memset(blocks[i], 'A' + i, sizeof(Student));
+        }
+        allocator.free(blocks[1]);
+        allocator.free(blocks[4]);
+        allocator.free(blocks[6]);
+        blocks[1] = allocator.allocate("leak");
+        memset(blocks[1], 'a', sizeof(Student));
+        checkAndDumpLeaks(&allocator);
+        for (unsigned i = 0; i < 6; i++)
+          if (i != 4)
+            allocator.free(blocks[i]);
+        checkAndDumpLeaks(&allocator);
+      }
+    }
+    cout << endl;
+
+    // concurrent mode, after the worker has exited
+    SimpleAllocatorConfig config(false, 4, 0);
+    config.maxPages = UNLIMITED_PAGES;
+    config.isConcurrent = true;
+    SimpleAllocator concurrent(sizeof(Student), config);
+    std::vector<void *> kept;
+    std::thread worker([&]() {
+      void *blocks[20];
+      for (unsigned i = 0; i < 20; i++)
+        blocks[i] = concurrent.allocate();
+      for (unsigned i = 0; i < 20; i++)
+        if (i % 4 == 0)
+          kept.push_back(blocks[i]);
+        else
+          concurrent.free(blocks[i]);
+    });
+    worker.join();
+    cout << "concurrent: " << concurrent.dumpMemoryInUse(nullptr)
+         << " blocks in use" << endl;
+    for (void *p : kept)
+      concurrent.free(p);
+
+    // more than one bitmap word per page
+    SimpleAllocatorConfig wide(false, 200, 2);
+    SimpleAllocator allocator(sizeof(Student), wide);
+    std::vector<void *> blocks;
+    for (unsigned i = 0; i < 400; i++)
+      blocks.push_back(allocator.allocate());
+    for (unsigned i = 0; i < 400; i++)
+      if (i % 3 != 0 && i != 130 && i != 263)
+        allocator.free(blocks[i]);
+    cout << "200 objects per page: " << allocator.dumpMemoryInUse(nullptr)
+         << " blocks in use" << endl;
+    config = wide;
+    config.isChecked = false;
+    SimpleAllocator unchecked(sizeof(Student), config);
+    for (unsigned i = 0; i < 300; i++)
+      blocks[i] = unchecked.allocate();
+    for (unsigned i = 0; i < 300; i++)
+      if (i % 64 != 63)
+        unchecked.free(blocks[i]);
+    cout << "unchecked, 300 of 400 carved: "
+         << unchecked.dumpMemoryInUse(nullptr) << " blocks in use" << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test the arena calls
+ * 1. reset() frees every block and rewinds the pages, which are carved
+ *    again before any new page, even at the page limit
+ * 2. releaseAll() drops every page, and allocation starts over
+ * 3. unchecked mode touches no block, and keeps no more than
+ *    maxEmptyPages empty pages
+ * @param allocator allocator to test (4 objects per page, 3 pages,
+ *        external headers, 2 pad bytes, arena mode)
+ */
+void arenaTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running arenaTest with: " << endl;
+    printConfig(allocator);
+    cout << "isArena:" << allocator->getConfig().isArena << endl;
+    cout << endl;
+
+    void *blocks[13];
+    for (unsigned i = 0; i < 10; i++)
+      blocks[i] = allocator->allocate("arena");
+    allocator->free(blocks[3]);
+    allocator->free(blocks[8]);
+    printStats(allocator);
+    cout << "reset freed " << allocator->reset() << " blocks" << endl;
+    printStats(allocator);
+    cout << "in use: " << allocator->dumpMemoryInUse(nullptr)
+         << ", corrupted: " << allocator->dumpCorruptedMemory(validateCallback)
+         << endl;
+    dumpPagesWithExtHdrs(allocator, 24);
+    cout << endl;
+
+    // the rewound pages come back before the page limit is hit
+    unsigned allocated = 0;
+    try {
+      for (; allocated < 13; allocated++)
+        blocks[allocated] = allocator->allocate("again");
+    } catch (const SimpleAllocatorException &e) {
+      if (e.code() == SimpleAllocatorException::E_NO_PAGE)
+        cout << "E_NO_PAGE after ";
+    }
+    cout << allocated << " blocks" << endl;
+    printStats(allocator);
+    try {
+      allocator->free(blocks[0]);
+      allocator->reset();
+      allocator->allocate("after");
+      allocator->free(blocks[1]);
+    } catch (const SimpleAllocatorException &e) {
+      if (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE)
+        cout << "free() after reset: E_MULTIPLE_FREE" << endl;
+    }
+
+    cout << "releaseAll released " << allocator->releaseAll() << " pages"
+         << endl;
+    printStats(allocator);
+    blocks[0] = allocator->allocate("fresh");
+    cout << "allocate() after releaseAll: ";
+    printStats(allocator);
+
+    // the unchecked path drops everything as it is
+    SimpleAllocatorConfig config = allocator->getConfig();
+    config.isChecked = false;
+    config.maxEmptyPages = 1;
+    SimpleAllocator unchecked(sizeof(Student), config);
+    for (unsigned i = 0; i < 10; i++)
+      blocks[i] = unchecked.allocate();
+    unchecked.free(blocks[2]);
+    cout << "unchecked reset freed " << unchecked.reset() << " blocks" << endl;
+    printStats(&unchecked);
+    for (unsigned i = 0; i < 6; i++)
+      blocks[i] = unchecked.allocate();
+    cout << "in use after 6 more: " << unchecked.dumpMemoryInUse(nullptr)
+         << endl;
+    printStats(&unchecked);
+
+    // no arena with threads
+    config.isConcurrent = true;
+    SimpleAllocator concurrent(sizeof(Student), config);
+    concurrent.allocate();
+    cout << "concurrent: isArena:" << concurrent.getConfig().isArena
+         << ", reset freed " << concurrent.reset() << " blocks" << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+// corrupted blocks the background sweeper has reported
+std::atomic<unsigned> sweptCorrupted(0);
+
+/**
+ * Callback for the background sweeper, counting instead of printing
+ * (it runs on the sweeper thread)
+ * @param block pointer to the corrupted block
+ * @param size size of the block
+ */
+void countCallback(const void *block, size_t size) {
+  if (block && size)
+    sweptCorrupted++;
+}
+
+/**
+ * Test the corruption sweeps
+ * 1. dumpCorruptedMemory() reports overruns and underruns of blocks that
+ *    are neither allocated nor freed again
+ * 2. sweepCorruptedMemory() covers the same blocks a few at a time
+ * 3. a background sweeper finds an overrun in concurrent mode
+ * @param allocator allocator to test (4 objects per page, 3 pages,
+ *        2 pad bytes)
+ */
+void sweepTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running sweepTest with: " << endl;
+    printConfig(allocator);
+    cout << endl;
+
+    void *blocks[6];
+    for (unsigned i = 0; i < 6; i++)
+      blocks[i] = allocator->allocate();
+    allocator->free(blocks[5]);
+    cout << "intact: " << allocator->dumpCorruptedMemory(validateCallback)
+         << " corrupted blocks" << endl;
+
+    // one byte past block 1, one byte before block 4 and one byte past
+    // the freed block 5
+    static_cast<char *>(blocks[1])[sizeof(Student)] = 0;
+    static_cast<char *>(blocks[4])[-1] = 0;
+    static_cast<char *>(blocks[5])[sizeof(Student) + 1] = 0;
+    cout << "dumpCorruptedMemory:" << endl;
+    unsigned corrupted = allocator->dumpCorruptedMemory(validateCallback);
+    cout << corrupted << " corrupted blocks" << endl;
+    cout << endl;
+
+    // 8 blocks on 2 pages, 3 at a time (the fourth step starts over)
+    for (unsigned step = 1; step <= 4; step++) {
+      cout << "step " << step << ":" << endl;
+      unsigned found = allocator->sweepCorruptedMemory(3, validateCallback);
+      cout << "  " << found << " corrupted blocks" << endl;
+    }
+    cout << "startSweeper in single-threaded mode: "
+         << (allocator->startSweeper(countCallback, 1, 1) ? "started"
+                                                          : "refused")
+         << endl;
+    cout << endl;
+
+    // the sweeper runs next to threads allocating and freeing
+    SimpleAllocatorConfig config = allocator->getConfig();
+    config.isConcurrent = true;
+    config.maxPages = UNLIMITED_PAGES;
+    SimpleAllocator concurrent(sizeof(Student), config);
+    void *victim = concurrent.allocate();
+    cout << "startSweeper: "
+         << (concurrent.startSweeper(countCallback, 2, 1) ? "started"
+                                                          : "refused")
+         << endl;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 2; t++)
+      threads.emplace_back([&concurrent]() {
+        void *held[16];
+        for (unsigned round = 0; round < 200; round++) {
+          for (unsigned i = 0; i < 16; i++)
+            held[i] = concurrent.allocate();
+          for (unsigned i = 0; i < 16; i++)
+            concurrent.free(held[i]);
+        }
+      });
+    for (std::thread &thread : threads)
+      thread.join();
+    cout << "corrupted blocks while intact: " << sweptCorrupted.load()
+         << endl;
+    static_cast<char *>(victim)[sizeof(Student)] = 0;
+    for (unsigned wait = 0; wait < 5000 && sweptCorrupted.load() == 0;
+         wait++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    concurrent.stopSweeper();
+    cout << "background sweeper found the overrun: "
+         << (sweptCorrupted.load() > 0 ? "yes" : "no") << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test the remote-free queues in a producer/consumer hand-off
+ * 1. the producer's first 16 blocks come off the constructor's page, which
+ *    has no owner; the next 16 come off a page its refill made
+ * 2. the consumer frees all 32: the first 16 go to its own magazine (and
+ *    the shared list), the other 16 to the producer's queue
+ * 3. the producer's magazine runs dry and it takes its 16 blocks back
+ *    from the queue, without a refill
+ * 4. a consumer that stays alive gives those 16 back with one
+ *    freeBatch(), which routes them to the producer's queue too, so the
+ *    producer takes all of them again
+ * 5. once the producer has exited, frees on its page stay in the freeing
+ *    thread's magazine
+ * @param allocator allocator to test (16 objects per page, no page limit,
+ *        concurrent mode, magazines of 8 blocks, remote frees)
+ */
+void remoteFreeTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running remoteFreeTest with: " << endl;
+    printConfig(allocator);
+    cout << "remoteFrees:" << allocator->getConfig().remoteFrees << endl;
+    cout << endl;
+
+    // each step runs on its own thread, one after the other
+    std::atomic<int> step(0);
+    auto waitFor = [&step](int s) {
+      while (step.load() != s)
+        std::this_thread::yield();
+    };
+    std::vector<void *> produced(32), reused(16), again(16);
+    std::thread producer([&]() {
+      for (unsigned i = 0; i < 32; i++)
+        produced[i] = allocator->allocate();
+      step = 1;
+      waitFor(2);
+      for (unsigned i = 0; i < 16; i++)
+        reused[i] = allocator->allocate();
+      step = 3;
+      waitFor(4);
+      for (unsigned i = 0; i < 16; i++)
+        again[i] = allocator->allocate();
+      step = 5;
+      waitFor(6);
+    });
+    waitFor(1);
+    cout << "producer allocated 32 blocks:" << endl;
+    printStats(allocator);
+
+    std::thread consumer([&]() {
+      for (unsigned i = 0; i < 32; i++)
+        allocator->free(produced[i]);
+    });
+    consumer.join();
+    cout << "consumer freed them (16 on the producer's queue):" << endl;
+    printStats(allocator);
+
+    step = 2;
+    waitFor(3);
+    unsigned fromQueue = 0;
+    for (void *p : reused)
+      for (unsigned i = 16; i < 32; i++)
+        if (p == produced[i])
+          fromQueue++;
+    cout << "producer allocated 16 more, " << fromQueue
+         << " of them from its queue:" << endl;
+    printStats(allocator);
+
+    // the consumer stays alive, so anything left in its magazine stays there
+    std::atomic<bool> batchFreed(false), done(false);
+    std::thread batchConsumer([&]() {
+      allocator->freeBatch(16, reused.data());
+      batchFreed = true;
+      while (!done.load())
+        std::this_thread::yield();
+    });
+    while (!batchFreed.load())
+      std::this_thread::yield();
+    cout << "a consumer freed them in one batch:" << endl;
+    printStats(allocator);
+
+    step = 4;
+    waitFor(5);
+    fromQueue = 0;
+    for (void *p : again)
+      for (void *q : reused)
+        if (p == q)
+          fromQueue++;
+    cout << "producer allocated 16 more, " << fromQueue
+         << " of them from its queue:" << endl;
+    printStats(allocator);
+    done = true;
+    batchConsumer.join();
+
+    step = 6;
+    producer.join();
+    for (void *p : again)
+      allocator->free(p);
+    cout << "main freed them after the producer exited:" << endl;
+    printStats(allocator);
+    cout << "blocks in use (main's magazine included): "
+         << allocator->dumpMemoryInUse(nullptr) << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Print the counts of a sharded allocator that do not depend on which
+ * CPUs its threads ran on
+ * @param allocator the allocator
+ */
+void printShardedCounts(const ShardedAllocator &allocator) {
+  SimpleAllocatorStats stats = allocator.getStats();
+  cout << "objectsInUse: " << stats.objectsInUse;
+  cout << ", allocations: " << stats.allocations;
+  cout << ", frees: " << stats.deallocations << endl;
+  cout << endl;
+}
+
+/**
+ * Try to free a block through a sharded allocator, and report the
+ * exception it throws
+ * @param allocator the allocator
+ * @param p the block
+ * @param what what kind of free it is
+ */
+void tryShardedFree(ShardedAllocator &allocator, void *p, const char *what) {
+  try {
+    allocator.free(p);
+    cout << what << ": freed" << endl;
+  } catch (const SimpleAllocatorException &e) {
+    cout << what << ": "
+         << (e.code() == SimpleAllocatorException::E_MULTIPLE_FREE
+                 ? "E_MULTIPLE_FREE"
+                 : e.code() == SimpleAllocatorException::E_BAD_BOUNDARY
+                       ? "E_BAD_BOUNDARY"
+                       : "other exception")
+         << endl;
+  }
+}
+
+/**
+ * Test the per-CPU shards
+ * (which CPU a thread runs on is up to the machine, so only what holds on
+ * any machine is printed)
+ * 1. every block finds the shard it came from, and the shards' stats add
+ *    up to the totals
+ * 2. 100 short-lived threads hold on to no memory of their own
+ * 3. blocks freed from another thread go back to their shards
+ * 4. nullptr, a block of another allocator, malloc memory and a double
+ *    free are caught
+ * 5. every page is empty at the end
+ */
+void shardTest() {
+  try {
+    SimpleAllocatorConfig config(false, 16, UNLIMITED_PAGES,
+        SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+        0, 2, true);
+    ShardedAllocator allocator(sizeof(Student), config, 4);
+    cout << "Running shardTest with: " << endl;
+    printConfig(allocator.getShard(0));
+    cout << "shards:" << allocator.numShards() << endl;
+    cout << endl;
+
+    std::vector<void *> blocks;
+    for (unsigned i = 0; i < 40; i++)
+      blocks.push_back(allocator.allocate());
+    bool found = true;
+    for (void *p : blocks) {
+      const SimpleAllocator *owner = allocator.getShard(0)->ownerOf(p);
+      bool shard = false;
+      for (unsigned s = 0; s < allocator.numShards(); s++)
+        shard = shard || owner == allocator.getShard(s);
+      found = found && shard;
+    }
+    cout << "every block has its shard: " << (found ? "yes" : "no") << endl;
+    unsigned inUse = 0;
+    for (unsigned s = 0; s < allocator.numShards(); s++)
+      inUse += allocator.getShardStats(s).pool.objectsInUse;
+    cout << "objects in use over the shards: " << inUse << endl;
+    printShardedCounts(allocator);
+
+    // one thread after the other, 8 blocks each
+    for (unsigned t = 0; t < 100; t++) {
+      std::thread worker([&allocator]() {
+        void *held[8];
+        for (unsigned i = 0; i < 8; i++)
+          held[i] = allocator.allocate();
+        for (unsigned i = 0; i < 8; i++)
+          allocator.free(held[i]);
+      });
+      worker.join();
+    }
+    // a shard never held more than its share of the 40 blocks plus 8, so
+    // the shards need at most (40 + 4 x 8) / 16 pages, plus a partly used
+    // page each, however many threads came and went
+    SimpleAllocatorStats stats = allocator.getStats();
+    cout << "after 100 threads, at most 8 pages: "
+         << (stats.pagesInUse <= 8 ? "yes" : "no") << endl;
+    printShardedCounts(allocator);
+
+    std::thread consumer([&]() {
+      for (void *p : blocks)
+        allocator.free(p);
+    });
+    consumer.join();
+    cout << "another thread freed the first 40:" << endl;
+    printShardedCounts(allocator);
+
+    ShardedAllocator other(sizeof(Student), config, 2);
+    void *foreign = other.allocate();
+    void *a = allocator.allocate();
+    void *b = allocator.allocate();
+    tryShardedFree(allocator, nullptr, "nullptr");
+    tryShardedFree(allocator, foreign, "block of another allocator");
+    void *heap = std::malloc(sizeof(Student));
+    tryShardedFree(allocator, heap, "malloc memory");
+    std::free(heap);
+    tryShardedFree(allocator, a, "first free");
+    tryShardedFree(allocator, a, "second free");
+    allocator.free(b);
+    other.free(foreign);
+    allocator.freeEmptyPages();
+    cout << "pages left after freeEmptyPages: "
+         << allocator.getStats().pagesInUse << endl;
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Find a block in the pages of an allocator
+ * @param pageList head of the allocator's page list
+ * @param p the block
+ * @param pageBytes bytes at the start of a page that hold its blocks
+ * @return the page's place in the list times pageBytes plus the block's
+ *         offset in it, or -1 if none of the pages holds it
+ */
+long locateBlock(const void *pageList, const void *p, size_t pageBytes) {
+  const char *block = static_cast<const char *>(p);
+  long index = 0;
+  for (const Node *page = static_cast<const Node *>(pageList); page != nullptr;
+       page = page->pNext, index++) {
+    const char *start = reinterpret_cast<const char *>(page);
+    if (block >= start && block < start + pageBytes)
+      return index * static_cast<long>(pageBytes) + (block - start);
+  }
+  return -1;
+}
+
+/**
+ * Check that a SimpleAllocator and a FixedAllocator are in the same state:
+ * the same stats, the same free list (as page and offset), and, when
+ * checked, the same bytes in every page up to the end of its last block
+ * (apart from the page link and the free list links)
+ * @param simple the runtime allocator
+ * @param fixed the fixed allocator
+ * @return true if they are the same
+ */
+template <typename Fixed>
+bool sameState(const SimpleAllocator &simple, const Fixed &fixed) {
+  SimpleAllocatorStats a = simple.getStats(), b = fixed.getStats();
+  if (a.objectSize != b.objectSize || a.blockSize != b.blockSize ||
+      a.pageSize != b.pageSize || a.alignBytes != b.alignBytes ||
+      a.overheadBytes != b.overheadBytes || a.freeObjects != b.freeObjects ||
+      a.objectsInUse != b.objectsInUse || a.pagesInUse != b.pagesInUse ||
+      a.mostObjects != b.mostObjects || a.allocations != b.allocations ||
+      a.deallocations != b.deallocations || a.pageBytes != b.pageBytes)
+    return false;
+
+  // the free lists, in order
+  std::set<long> links;
+  const Node *x = static_cast<const Node *>(simple.getFreeList());
+  const Node *y = static_cast<const Node *>(fixed.getFreeList());
+  for (; x != nullptr && y != nullptr; x = x->pNext, y = y->pNext) {
+    long at = locateBlock(simple.getPageList(), x, Fixed::BLOCKS_END);
+    if (at < 0 || at != locateBlock(fixed.getPageList(), y, Fixed::BLOCKS_END))
+      return false;
+    links.insert(at);
+  }
+  if (x != y)
+    return false;
+  if (!Fixed::IS_CHECKED)
+    return true;
+
+  // the page bytes, in order
+  const Node *p = static_cast<const Node *>(simple.getPageList());
+  const Node *q = static_cast<const Node *>(fixed.getPageList());
+  long index = 0;
+  for (; p != nullptr && q != nullptr; p = p->pNext, q = q->pNext, index++) {
+    const unsigned char *left = reinterpret_cast<const unsigned char *>(p);
+    const unsigned char *right = reinterpret_cast<const unsigned char *>(q);
+    for (size_t i = sizeof(void *); i < Fixed::BLOCKS_END; i++) {
+      long at = index * static_cast<long>(Fixed::BLOCKS_END);
+      bool link = false;
+      for (size_t k = 0; k < sizeof(Node) && k <= i && !link; k++)
+        link = links.count(at + static_cast<long>(i - k)) > 0;
+      if (!link && left[i] != right[i])
+        return false;
+    }
+  }
+  return p == nullptr && q == nullptr;
+}
+
+/**
+ * Call a function, and return the code of the exception it throws
+ * @param f the function
+ * @return the exception's code, or -1 if there was none
+ */
+template <typename F> int exceptionCode(F f) {
+  try {
+    f();
+  } catch (const SimpleAllocatorException &e) {
+    return e.code();
+  }
+  return -1;
+}
+
+/**
+ * Test a FixedAllocator against a SimpleAllocator made from its getConfig()
+ * 1. the same random sequence of allocations, client writes and frees
+ *    leaves both in the same state after every step
+ * 2. the same blocks come back, on the same page at the same offset
+ * 3. (checked) double frees, frees off a block boundary and overwritten
+ *    pads throw the same exceptions in both, and so does a double free
+ *    once nothing is in use
+ * 4. running out of pages throws E_NO_PAGE in both
+ * @param name name of the configuration
+ * @param maxPages maximum number of pages
+ */
+template <typename Fixed> void fixedTest(const char *name, unsigned maxPages) {
+  try {
+    Fixed fixed(maxPages);
+    SimpleAllocator simple(fixed.getStats().objectSize, fixed.getConfig());
+    cout << "Running fixedTest<" << name << "> with: " << endl;
+    printConfig(&simple);
+    cout << "firstBlock:" << Fixed::FIRST_BLOCK_OFFSET
+         << ", stride:" << Fixed::STRIDE << ", span:" << Fixed::PAGE_SPAN
+         << ", checked:" << Fixed::IS_CHECKED << endl;
+    cout << "same config: "
+         << (simple.getConfig().leftAlignBytesSize ==
+                     fixed.getConfig().leftAlignBytesSize &&
+                 simple.getConfig().interAlignBytesSize ==
+                     fixed.getConfig().interAlignBytesSize
+                 ? "yes"
+                 : "no")
+         << endl;
+
+    std::vector<std::pair<void *, void *> > held;
+    std::pair<void *, void *> lastFreed(nullptr, nullptr);
+    std::map<int, unsigned> exceptions;
+    unsigned mismatches = 0, steps = 400, frees = 0;
+    size_t pad = fixed.getConfig().padBytesSize;
+    for (unsigned step = 0; step < steps; step++) {
+      int r = randInt(0, 9);
+      int codeA = -1, codeB = -1;
+      if (r >= 8 && Fixed::IS_CHECKED && !held.empty()) {
+        // a double free, or a free off a block boundary
+        std::pair<void *, void *> bad =
+            r == 8 && lastFreed.first != nullptr
+                ? lastFreed
+                : std::make_pair(static_cast<void *>(
+                                     static_cast<char *>(held.back().first) + 1),
+                                 static_cast<void *>(
+                                     static_cast<char *>(held.back().second) + 1));
+        codeA = exceptionCode([&]() { simple.free(bad.first); });
+        codeB = exceptionCode([&]() { fixed.free(bad.second); });
+      } else if (r >= 5 && !held.empty()) {
+        size_t i = static_cast<size_t>(randInt(0, static_cast<int>(held.size()) - 1));
+        std::pair<void *, void *> block = held[i];
+        if (Fixed::IS_CHECKED && pad > 0 && frees % 10 == 0) {
+          // overrun the block into its right pad
+          char *a = static_cast<char *>(block.first), *b = static_cast<char *>(block.second);
+          a[fixed.getStats().objectSize] = 0;
+          b[fixed.getStats().objectSize] = 0;
+          codeA = exceptionCode([&]() { simple.free(block.first); });
+          codeB = exceptionCode([&]() { fixed.free(block.second); });
+          exceptions[codeA]++;
+          mismatches += codeA != codeB || !sameState(simple, fixed);
+          a[fixed.getStats().objectSize] = static_cast<char>(SimpleAllocator::PAD_PATTERN);
+          b[fixed.getStats().objectSize] = static_cast<char>(SimpleAllocator::PAD_PATTERN);
+        }
+        codeA = exceptionCode([&]() { simple.free(block.first); });
+        codeB = exceptionCode([&]() { fixed.free(block.second); });
+        held.erase(held.begin() + static_cast<long>(i));
+        lastFreed = block;
+        frees++;
+      } else {
+        void *a = nullptr, *b = nullptr;
+        codeA = exceptionCode([&]() { a = simple.allocate(); });
+        codeB = exceptionCode([&]() { b = fixed.allocate(); });
+        if (a != nullptr && b != nullptr) {
+          // the client writes its object
+          int value = randInt(0, 255);
+          std::memset(a, value, fixed.getStats().objectSize);
+          std::memset(b, value, fixed.getStats().objectSize);
+          held.push_back(std::make_pair(a, b));
+          // it may be the block freed last, which is in use again
+          lastFreed = std::make_pair(nullptr, nullptr);
+          mismatches += locateBlock(simple.getPageList(), a, Fixed::BLOCKS_END) !=
+                        locateBlock(fixed.getPageList(), b, Fixed::BLOCKS_END);
+        }
+      }
+      if (codeA >= 0)
+        exceptions[codeA]++;
+      mismatches += codeA != codeB || !sameState(simple, fixed);
+    }
+    for (const std::pair<void *, void *> &block : held) {
+      simple.free(block.first);
+      fixed.free(block.second);
+    }
+    mismatches += !sameState(simple, fixed);
+
+    cout << "steps: " << steps << ", mismatches: " << mismatches << endl;
+    if (Fixed::IS_CHECKED && !held.empty()) {
+      // nothing is in use any more, and the bitmap still knows the block
+      int codeA = exceptionCode([&]() { simple.free(held.back().first); });
+      int codeB = exceptionCode([&]() { fixed.free(held.back().second); });
+      cout << "double free of the last block: "
+           << (codeA == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+           << ", " << (codeB == SimpleAllocatorException::E_MULTIPLE_FREE ? "E_MULTIPLE_FREE" : "other")
+           << endl;
+    }
+    cout << "exceptions: E_NO_PAGE " << exceptions[SimpleAllocatorException::E_NO_PAGE]
+         << ", E_BAD_BOUNDARY " << exceptions[SimpleAllocatorException::E_BAD_BOUNDARY]
+         << ", E_MULTIPLE_FREE " << exceptions[SimpleAllocatorException::E_MULTIPLE_FREE]
+         << ", E_CORRUPTED_BLOCK " << exceptions[SimpleAllocatorException::E_CORRUPTED_BLOCK]
+         << endl;
+    printStats(&simple);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Find the place of a block's page in the page list
+ * @param allocator the allocator
+ * @param p the block
+ * @return index of the page, newest first (-1 if it is on none)
+ */
+int pageIndexOf(const SimpleAllocator *allocator, const void *p) {
+  const char *block = static_cast<const char *>(p);
+  size_t pageSize = allocator->getStats().pageSize;
+  int index = 0;
+  for (const Node *page = static_cast<const Node *>(allocator->getPageList());
+       page != nullptr; page = page->pNext, index++) {
+    const char *start = reinterpret_cast<const char *>(page);
+    if (block >= start && block < start + pageSize)
+      return index;
+  }
+  return -1;
+}
+
+/**
+ * Test page-local free lists
+ * 1. blocks freed all over four pages come back from the fullest page
+ *    first, and each page is used up before the next one is started
+ * 2. the page that was emptied is left alone, so freeEmptyPages()
+ *    releases it
+ * 3. after the same random churn, consecutive allocations span fewer
+ *    pages than with one free list for all pages
+ * 4. allocateBatch() and freeBatch() keep the counts right
+ */
+void pageLocalTest(SimpleAllocator *allocator) {
+  try {
+    cout << "Running pageLocalTest with: " << endl;
+    printConfig(allocator);
+    cout << "pageLocalFrees:" << allocator->getConfig().pageLocalFrees << endl;
+    cout << endl;
+
+    // four full pages, then leave 20, 8, 28 and 0 blocks live on them
+    std::vector<void *> blocks;
+    for (unsigned i = 0; i < 128; i++)
+      blocks.push_back(allocator->allocate());
+    const unsigned live[] = {20, 8, 28, 0};
+    std::map<int, unsigned> kept;
+    std::vector<void *> keptBlocks;
+    for (void *p : blocks) {
+      int page = pageIndexOf(allocator, p);
+      if (kept[page] < live[page]) {
+        kept[page]++;
+        keptBlocks.push_back(p);
+      } else {
+        allocator->free(p);
+      }
+    }
+    cout << "live blocks per page (newest first): 20 8 28 0" << endl;
+    printStats(allocator);
+
+    cout << "pages of the next 20 blocks:";
+    std::vector<void *> next;
+    for (unsigned i = 0; i < 20; i++) {
+      next.push_back(allocator->allocate());
+      cout << " " << pageIndexOf(allocator, next.back());
+    }
+    cout << endl;
+    cout << "pages released by freeEmptyPages: "
+         << allocator->freeEmptyPages() << endl;
+    printStats(allocator);
+    for (void *p : next)
+      allocator->free(p);
+    for (void *p : keptBlocks)
+      allocator->free(p);
+    cout << "all blocks freed:" << endl;
+    printStats(allocator);
+
+    // the same churn with one free list for all pages: the live blocks
+    // grow to 512 and shrink to 64 again, freed at random
+    SimpleAllocatorConfig config = allocator->getConfig();
+    config.pageLocalFrees = false;
+    SimpleAllocator global(allocator->getStats().objectSize, config);
+    std::vector<void *> mine, theirs;
+    bool growing = true;
+    for (unsigned step = 0; step < 20000; step++) {
+      if (mine.size() >= 512)
+        growing = false;
+      if (mine.size() <= 64)
+        growing = true;
+      if (mine.empty() || (randInt(0, 3) != 0) == growing) {
+        mine.push_back(allocator->allocate());
+        theirs.push_back(global.allocate());
+      } else {
+        size_t i = static_cast<size_t>(randInt(0, static_cast<int>(mine.size()) - 1));
+        allocator->free(mine[i]);
+        global.free(theirs[i]);
+        mine.erase(mine.begin() + static_cast<long>(i));
+        theirs.erase(theirs.begin() + static_cast<long>(i));
+      }
+    }
+    std::set<int> minePages, theirPages;
+    for (void *p : mine)
+      minePages.insert(pageIndexOf(allocator, p));
+    for (void *p : theirs)
+      theirPages.insert(pageIndexOf(&global, p));
+    cout << "after churn, " << mine.size() << " blocks live on "
+         << minePages.size() << " pages page-local, " << theirPages.size()
+         << " pages with one free list" << endl;
+    minePages.clear();
+    theirPages.clear();
+    for (unsigned i = 0; i < 16; i++) {
+      mine.push_back(allocator->allocate());
+      theirs.push_back(global.allocate());
+      minePages.insert(pageIndexOf(allocator, mine.back()));
+      theirPages.insert(pageIndexOf(&global, theirs.back()));
+    }
+    cout << "pages spanned by 16 allocations in a row: " << minePages.size()
+         << " page-local, " << theirPages.size() << " with one free list"
+         << endl;
+    cout << "empty pages released: " << allocator->freeEmptyPages()
+         << " page-local, " << global.freeEmptyPages()
+         << " with one free list" << endl;
+    for (void *p : theirs)
+      global.free(p);
+
+    void *batch[20];
+    allocator->allocateBatch(20, batch);
+    cout << "allocateBatch(20), blocks in use: "
+         << allocator->dumpMemoryInUse(nullptr) << endl;
+    printStats(allocator);
+    allocator->freeBatch(20, batch);
+    for (void *p : mine)
+      allocator->free(p);
+    cout << "freeBatch(20) and the rest freed, blocks in use: "
+         << allocator->dumpMemoryInUse(nullptr) << ", pages released: "
+         << allocator->freeEmptyPages() << endl;
+    printStats(allocator);
+
+    // catch and act on our custom exceptions
+  } catch (const SimpleAllocatorException &e) {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during test." << endl;
+    return;
+  }
+}
+
+/**
+ * Test objects smaller than the free list link, for which the allocator
+ * makes room for the link
+ * 1. the object size is raised to sizeof(Node)
+ * 2. fill every page, writing all of each 4-byte object, and free every
+ *    block again, so every block holds a link at some point
+ * 3. nothing is corrupted, a double free is still caught, and every page
+ *    can be released (the page footers were never overwritten)
+ * @param allocator allocator to test (made with objectSize 4)
+ */
+void smallObjectTest(SimpleAllocator *allocator) {
   try {
-    // print a title of the test
-    cout << "Running corruptionTest with: " << endl;
-
-    // print the config
+    cout << "Running smallObjectTest with: " << endl;
     printConfig(allocator);
     cout << endl;
 
-    // num objects to allocate
-    auto numObjsToAllocate = 8;
-
-    // init a ptrs array
-    void *ptrs[numObjsToAllocate];
-    
-    // allocate memory into the ptrs array
-    for (auto i = 0; i < numObjsToAllocate; i++) {
+    unsigned numObjs = allocator->getConfig().objectsPerPage *
+                       allocator->getConfig().maxPages;
+    std::vector<void *> ptrs(numObjs);
+    for (unsigned i = 0; i < numObjs; i++) {
       ptrs[i] = allocator->allocate();
+      std::memset(ptrs[i], 0x11, 4);
     }
-
-    // print the stats and dump the pages
-    cout << "After " << numObjsToAllocate << " allocations..." << endl;
+    cout << "After " << numObjs << " allocations..." << endl;
     printStats(allocator);
-    dumpPages(allocator, 32);
-
-    // fabricate some memory corruption in left pad bytes of a block
-    // 1. get the first byte of the first object
-    // 2. subtract the pad bytes from the address
-    // 3. set some pad bytes to 0xFF (no such signature in SimpleAllocator)
-    auto padBytes = allocator->getConfig().padBytesSize;
-    auto pByte = static_cast<unsigned char*>(ptrs[0]) - padBytes;
-    auto bytesToCorrupt = (padBytes > 3) ? 3 : padBytes;
-    for (unsigned i = 0; i < bytesToCorrupt; i++) {
-      *pByte++ = 0xFF;
-    }
-
-    // TODO: make an input arg to select whether to corrupt left or right
-    // fabricate another memory corruption in the right pad bytes of a block
-    // 1. get the first byte of the second object
-    // 2. add the object size to the address
-    // 3. set some pad bytes to 0xEE (the alignment signature)
-    auto objSize = allocator->getStats().objectSize;
-    pByte = static_cast<unsigned char*>(ptrs[1]) + objSize;
-    for (auto i = bytesToCorrupt; i < padBytes ; i++) {
-      *pByte++ = 0xEE;
-    }
-    
-    // print the stats and dump the pages
-    cout << "After some corruption..." << endl;
+    shuffle(ptrs.data(), numObjs);
+    for (unsigned i = 0; i < numObjs; i++)
+      allocator->free(ptrs[i]);
+    cout << "After " << numObjs << " frees..." << endl;
     printStats(allocator);
-    dumpPages(allocator, 32);
-
-    // now try to free the corrupted blocks
-    // 1. free the first block
-    // 2. free the second block
-    // 3. let the exceptions show themselves
-    allocator->free(ptrs[0]);
-    allocator->free(ptrs[1]);
 
-    // print stats and dump the pages if no exception from above
-    // - the expected behavior is that the above will throw an exception
-    cout << "After " << "2" << " frees..." << endl;
+    cout << "corrupted: " << allocator->dumpCorruptedMemory(validateCallback)
+         << endl;
+    tryFree(allocator, ptrs[0], "freed block");
+    cout << "freeEmptyPages released " << allocator->freeEmptyPages()
+         << " pages" << endl;
     printStats(allocator);
-    dumpPages(allocator, 32);
 
     // catch and act on our custom exceptions
   } catch (const SimpleAllocatorException &e) {
@@ -859,10 +3091,6 @@ void dumpPagesWithExtHdrs(const SimpleAllocator *allocator, unsigned width) {
  * The main function
  * @param argc number of command line arguments
  * @param argv array of command line arguments
- * TODO alignmentTest next time. Yes we do not have a test for alignment
- *      so students do not really need to implement alignment in order 
- *      to pass the current tests. But it is still a recommended feature.
- *      Students are also encouraged to write their own tests.
  */
 int main(int argc, char *argv[]) {
   // test number
@@ -1090,6 +3318,389 @@ int main(int argc, char *argv[]) {
     //allocFreeTest(allocator, 3, 2, true);
     cout << endl;
     break;
+  case 11:
+    cout << "=== Test concurrent allocator" 
+         << " with thread magazines" 
+         << " and padding ===" << endl;
+
+    // create the allocator, switching on concurrent mode before construction
+    {
+      SimpleAllocatorConfig config(false, 64, 64,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 2, true);
+      config.isConcurrent = true;
+      config.magazineSize = 16;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    concurrentTest(allocator, 4, 100, 200);
+    cout << endl;
+    break;
+  case 12:
+    cout << "=== Test concurrent allocator" 
+         << " with lock-free shared free list" 
+         << " and no thread magazines ===" << endl;
+
+    // create the allocator, every allocate/free goes to the lock-free stack
+    {
+      SimpleAllocatorConfig config(false, 64, 64,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 2, true);
+      config.isConcurrent = true;
+      config.isLockFree = true;
+      config.magazineSize = 0;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    concurrentTest(allocator, 8, 50, 200);
+    cout << endl;
+    break;
+  case 13:
+    cout << "=== Test allocator" 
+         << " with basic headers" 
+         << " releasing empty pages ===" << endl;
+
+    // create the allocator
+    allocator = createAllocator(false, 
+            4, 
+            4, 
+            SimpleAllocatorConfig::BASIC_HEADER, 
+            0, 
+            0,
+            true,
+            TestObjectType::STUDENT_TYPE);
+
+    // run the test
+    emptyPagesTest(allocator);
+    cout << endl;
+    break;
+  case 14:
+    cout << "=== Test allocator" 
+         << " with thousands of pages" 
+         << " and bad frees ===" << endl;
+
+    // create the allocator
+    allocator = createAllocator(false, 
+            8, 
+            4000, 
+            SimpleAllocatorConfig::BASIC_HEADER, 
+            0, 
+            0,
+            true,
+            TestObjectType::STUDENT_TYPE);
+
+    // run the test
+    badFreeTest(allocator);
+    cout << endl;
+    break;
+  case 15:
+    cout << "=== Test allocator" 
+         << " with basic headers and padding" 
+         << " using batch calls ===" << endl;
+
+    // create the allocator
+    allocator = createAllocator(false, 
+            4, 
+            4, 
+            SimpleAllocatorConfig::BASIC_HEADER, 
+            0, 
+            2,
+            true,
+            TestObjectType::STUDENT_TYPE);
+
+    // run the test
+    batchTest(allocator);
+    cout << endl;
+    break;
+  case 16:
+    cout << "=== Test size-class allocator" 
+         << " with mixed object sizes" 
+         << " and oversized objects ===" << endl;
+
+    // run the test, the allocator owns its own pools
+    sizeClassTest();
+    cout << endl;
+    break;
+  case 17:
+    cout << "=== Test allocator" 
+         << " with pages from mmap regions" 
+         << " releasing empty pages ===" << endl;
+
+    // create the allocator, same layout as test 13 but with an mmap page source
+    {
+      SimpleAllocatorConfig config(false, 4, 4,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 0, true);
+      config.useMmap = true;
+      config.hugePages = SimpleAllocatorConfig::TRANSPARENT_HUGE_PAGES;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    emptyPagesTest(allocator);
+    cout << endl;
+    break;
+  case 18:
+    cout << "=== Test allocator" 
+         << " with basic headers and padding" 
+         << " aligned to 16 bytes ===" << endl;
+
+    // create the allocator
+    allocator = createAllocator(false, 
+            4, 
+            2, 
+            SimpleAllocatorConfig::BASIC_HEADER, 
+            16, 
+            2,
+            true,
+            TestObjectType::STUDENT_TYPE);
+
+    // run the test
+    alignmentTest(allocator);
+    cout << endl;
+    break;
+  case 19:
+    cout << "=== Test allocator" 
+         << " with external headers" 
+         << " sharing interned labels ===" << endl;
+
+    // create the allocator
+    allocator = createAllocator(false, 
+            4, 
+            2, 
+            SimpleAllocatorConfig::EXTERNAL_HEADER, 
+            0, 
+            0,
+            true,
+            TestObjectType::STUDENT_TYPE);
+
+    // run the test
+    labelTest(allocator);
+    cout << endl;
+    break;
+  case 20:
+    cout << "=== Test allocator" 
+         << " with growing pages" 
+         << " and no page limit ===" << endl;
+
+    // create the allocator, pages double from 2 up to 32 objects
+    {
+      SimpleAllocatorConfig config(false, 2, UNLIMITED_PAGES,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 0, true);
+      config.maxObjectsPerPage = 32;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    growthTest(allocator);
+    cout << endl;
+    break;
+  case 21:
+    cout << "=== Test pmr memory resource" 
+         << " with std::pmr containers" 
+         << " and upstream fallback ===" << endl;
+
+    // run the test, the resource owns its own pools
+    memoryResourceTest();
+    cout << endl;
+    break;
+  case 22:
+    cout << "=== Test standard allocator adapter" 
+         << " with node-based containers" 
+         << " sharing pools ===" << endl;
+
+    // run the test, the pool set owns its own pools
+    stdAllocatorTest();
+    cout << endl;
+    break;
+  case 23:
+    cout << "=== Test allocator" 
+         << " with external headers" 
+         << " recording an event trace ===" << endl;
+
+    // create the allocator, keeping the last 64 events
+    {
+      SimpleAllocatorConfig config(false, 4, 3,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::EXTERNAL_HEADER),
+          0, 0, true);
+      config.traceEvents = 64;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    traceTest(allocator);
+    cout << endl;
+    break;
+  case 24:
+    cout << "=== Test allocator" 
+         << " with basic headers" 
+         << " recording a workload for replay ===" << endl;
+
+    // create the allocator
+    allocator = new SimpleAllocator(sizeof(Student), SimpleAllocatorConfig(false, 4, 3,
+        SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+        0, 0, true));
+
+    // run the test
+    workloadTest(allocator);
+    cout << endl;
+    break;
+  case 25:
+    cout << "=== Test allocator" 
+         << " with basic headers and pad bytes" 
+         << " poisoning instead of patterns ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 4, 3,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 4, true);
+      config.poisonMemory = true;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    poisonTest(allocator);
+    cout << endl;
+    break;
+  case 26:
+    cout << "=== Test allocator" 
+         << " with basic headers" 
+         << " holding freed blocks in a quarantine ===" << endl;
+
+    // create the allocator, holding back two freed blocks
+    {
+      SimpleAllocatorConfig config(false, 4, 3,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 0, true);
+      config.quarantineBytes = 2 * sizeof(Student);
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    quarantineTest(allocator);
+    cout << endl;
+    break;
+  case 27:
+    cout << "=== Test allocator" 
+         << " with basic headers and padding" 
+         << " sweeping for corrupted blocks ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 4, 3,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 2, true);
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    sweepTest(allocator);
+    cout << endl;
+    break;
+  case 28:
+    cout << "=== Test leak dumps from the occupancy bitmaps"
+         << " with every header type ===" << endl;
+
+    // the test makes its own allocators
+    leakDumpTest();
+    cout << endl;
+    break;
+  case 29:
+    cout << "=== Test allocator" 
+         << " with external headers and padding"
+         << " in arena mode ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 4, 3,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::EXTERNAL_HEADER),
+          0, 2, true);
+      config.isArena = true;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    arenaTest(allocator);
+    cout << endl;
+    break;
+  case 30:
+    cout << "=== Test allocator" 
+         << " in concurrent mode"
+         << " with remote frees ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 16, UNLIMITED_PAGES);
+      config.isConcurrent = true;
+      config.magazineSize = 8;
+      config.remoteFrees = true;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    remoteFreeTest(allocator);
+    cout << endl;
+    break;
+  case 31:
+    cout << "=== Test per-CPU shards"
+         << " with basic headers and padding ===" << endl;
+
+    // the test makes its own allocators
+    shardTest();
+    cout << endl;
+    break;
+  case 32:
+    cout << "=== Test fixed-layout allocators"
+         << " against the runtime allocator ===" << endl;
+
+    // the test makes its own allocators
+    fixedTest<FixedAllocator<sizeof(Student), 8> >("no header", 4);
+    fixedTest<FixedAllocator<sizeof(Student), 8,
+        SimpleAllocatorConfig::BASIC_HEADER, 2> >("basic header, padding", 4);
+    fixedTest<FixedAllocator<sizeof(Student), 8,
+        SimpleAllocatorConfig::EXTENDED_HEADER, 4, 16, true, 2> >(
+        "extended header, padding, alignment", 4);
+    fixedTest<FixedAllocator<sizeof(Student), 8,
+        SimpleAllocatorConfig::BASIC_HEADER, 2, 0, false> >("unchecked", 4);
+    cout << endl;
+    break;
+  case 33:
+    cout << "=== Test allocator"
+         << " with page-local free lists ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 32, UNLIMITED_PAGES,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::BASIC_HEADER),
+          0, 2, true);
+      config.pageLocalFrees = true;
+      allocator = new SimpleAllocator(sizeof(Student), config);
+    }
+
+    // run the test
+    pageLocalTest(allocator);
+    cout << endl;
+    break;
+  case 34:
+    cout << "=== Test allocator"
+         << " with objects smaller than a free list link ===" << endl;
+
+    // create the allocator
+    {
+      SimpleAllocatorConfig config(false, 8, 4,
+          SimpleAllocatorConfig::HeaderBlockInfo(SimpleAllocatorConfig::NO_HEADER),
+          0, 0, true);
+      allocator = new SimpleAllocator(4, config);
+    }
+
+    // run the test
+    smallObjectTest(allocator);
+    cout << endl;
+    break;
   default:
     cout << "=== Bogus test number "<< test 
          << ", but here's some interesting info ===" << endl;
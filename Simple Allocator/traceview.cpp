@@ -0,0 +1,251 @@
+/**
+ * @file traceview.cpp
+ * @brief Offline viewer for SimpleAllocator trace dumps
+ *        (written by SimpleAllocator::dumpTrace, see SimpleTrace.h).
+ *        Prints a latency histogram for allocate and free, the allocations
+ *        per label, and a timeline of page occupancy.
+ *        Usage: ./traceview <dump-file> [timeline-rows]
+ * @date 16 Oct 2026
+ */
+
+#include "SimpleTrace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// latency buckets are powers of two in nanoseconds, the last one open-ended
+const unsigned NUM_BUCKETS = 16;
+
+// width of the '#' bars
+const unsigned BAR_WIDTH = 40;
+
+/**
+ * A page as the timeline sees it
+ */
+struct PageState {
+  uint64_t end;  // one past its last block
+  unsigned objects; // blocks on the page
+  unsigned live; // blocks allocated (or cached by a thread)
+};
+
+/**
+ * Print a bar of '#' for a fraction
+ * @param fraction from 0 to 1
+ */
+void printBar(double fraction) {
+  unsigned n = static_cast<unsigned>(fraction * BAR_WIDTH + 0.5);
+  for (unsigned i = 0; i < n; i++)
+    putchar('#');
+}
+
+/**
+ * Print the latency histogram of one event type
+ * @param trace the trace
+ * @param type ALLOCATE or FREE
+ * @param name name to print
+ */
+void printLatency(const SimpleTraceDump &trace, SimpleTraceEvent::Type type,
+                  const char *name) {
+  std::vector<double> latencies;
+  for (const SimpleTraceEvent &event : trace.events)
+    if (event.type == type)
+      latencies.push_back(event.value * 1e9 / trace.ticksPerSecond);
+  printf("%s latency (%zu events)\n", name, latencies.size());
+  if (latencies.empty()) {
+    printf("\n");
+    return;
+  }
+
+  unsigned buckets[NUM_BUCKETS] = {0};
+  for (double ns : latencies) {
+    unsigned bucket = 0;
+    while (bucket + 1 < NUM_BUCKETS && ns >= static_cast<double>(2ULL << bucket))
+      bucket++;
+    buckets[bucket]++;
+  }
+  unsigned most = *std::max_element(buckets, buckets + NUM_BUCKETS);
+  for (unsigned i = 0; i < NUM_BUCKETS; i++) {
+    if (buckets[i] == 0)
+      continue;
+    if (i + 1 < NUM_BUCKETS)
+      printf("  < %6llu ns %10u ", 2ULL << i, buckets[i]);
+    else
+      printf("  >=%6llu ns %10u ", 1ULL << i, buckets[i]);
+    printBar(static_cast<double>(buckets[i]) / most);
+    printf("\n");
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  size_t n = latencies.size();
+  printf("  min %.0f ns, p50 %.0f ns, p99 %.0f ns, max %.0f ns\n\n",
+         latencies[0], latencies[n / 2], latencies[(n - 1) * 99 / 100],
+         latencies[n - 1]);
+}
+
+/**
+ * Print the allocations per label
+ * @param trace the trace
+ */
+void printLabels(const SimpleTraceDump &trace) {
+  if (trace.labels.size() < 2)
+    return;
+  std::vector<unsigned> counts(trace.labels.size(), 0);
+  for (const SimpleTraceEvent &event : trace.events)
+    if (event.type == SimpleTraceEvent::ALLOCATE && event.labelId < counts.size())
+      counts[event.labelId]++;
+  printf("Allocations by label\n");
+  for (size_t i = 0; i < counts.size(); i++)
+    if (counts[i] > 0)
+      printf("  %-30s %10u\n", i == 0 ? "(none)" : trace.labels[i].c_str(),
+             counts[i]);
+  printf("\n");
+}
+
+/**
+ * Play one event on the pages, forwards or backwards
+ * @param trace the trace
+ * @param event the event
+ * @param pages pages by start address
+ * @param undo true to take the event back
+ * @return false if the block is not on a known page
+ */
+bool playEvent(const SimpleTraceDump &trace, const SimpleTraceEvent &event,
+               std::map<uint64_t, PageState> &pages, bool undo) {
+  bool adds = (event.type == SimpleTraceEvent::NEW_PAGE ||
+               event.type == SimpleTraceEvent::ALLOCATE) != undo;
+  if (event.type == SimpleTraceEvent::NEW_PAGE ||
+      event.type == SimpleTraceEvent::FREE_PAGE) {
+    // a page is empty when it is made and when it is released
+    if (adds) {
+      PageState page = {event.address + trace.firstBlockOffset +
+                            event.value * trace.blockStride,
+                        event.value, 0};
+      pages[event.address] = page;
+    } else {
+      pages.erase(event.address);
+    }
+    return true;
+  }
+
+  // find the page the block lies on
+  auto it = pages.upper_bound(event.address);
+  if (it == pages.begin() || event.address >= (--it)->second.end)
+    return false;
+  if (adds && it->second.live < it->second.objects)
+    it->second.live++;
+  else if (!adds && it->second.live > 0)
+    it->second.live--;
+  return true;
+}
+
+/**
+ * Print the page occupancy at evenly spaced times
+ * - with the pages of the dump, the events are taken back one by one from
+ *   the end of the trace, so the timeline is right even when the ring
+ *   has wrapped; without them (lock-free list) the events are played
+ *   forwards from the oldest one, and blocks on pages made before it
+ *   are only counted
+ * @param trace the trace
+ * @param rows number of points in time
+ */
+void printTimeline(const SimpleTraceDump &trace, unsigned rows) {
+  if (trace.events.empty())
+    return;
+  uint64_t first = trace.events.front().time;
+  uint64_t last = trace.events.back().time;
+  double span = last > first ? static_cast<double>(last - first) : 1.0;
+  bool backwards = !trace.pages.empty();
+
+  std::map<uint64_t, PageState> pages; // by start of the page
+  for (const SimpleTracePage &page : trace.pages) {
+    PageState state = {page.address + trace.firstBlockOffset +
+                           page.objects * trace.blockStride,
+                       page.objects, page.liveObjects};
+    pages[page.address] = state;
+  }
+
+  // the state at the end of every row
+  std::vector<PageState> totals(rows + 1);
+  std::vector<size_t> pageCounts(rows + 1);
+  unsigned unknown = 0;
+  size_t next = backwards ? trace.events.size() : 0;
+  for (unsigned i = 1; i <= rows; i++) {
+    unsigned row = backwards ? rows + 1 - i : i;
+    uint64_t until = first + static_cast<uint64_t>(span * row / rows);
+    if (backwards) {
+      // take back everything after the end of this row
+      for (; next > 0 && trace.events[next - 1].time > until && row < rows;
+           next--)
+        if (!playEvent(trace, trace.events[next - 1], pages, true))
+          unknown++;
+    } else {
+      // play everything up to the end of this row
+      for (; next < trace.events.size() &&
+             (trace.events[next].time <= until || row == rows);
+           next++)
+        if (!playEvent(trace, trace.events[next], pages, false))
+          unknown++;
+    }
+    PageState total = {0, 0, 0};
+    for (const auto &page : pages) {
+      total.objects += page.second.objects;
+      total.live += page.second.live;
+    }
+    totals[row] = total;
+    pageCounts[row] = pages.size();
+  }
+
+  printf("Page occupancy over time\n");
+  printf("  %10s %7s %10s %10s %6s\n", "ms", "pages", "objects", "in use",
+         "used");
+  for (unsigned row = 1; row <= rows; row++) {
+    double used = totals[row].objects > 0
+                      ? static_cast<double>(totals[row].live) / totals[row].objects
+                      : 0.0;
+    printf("  %10.3f %7zu %10u %10u %5.1f%% ",
+           span * row / rows * 1e3 / trace.ticksPerSecond, pageCounts[row],
+           totals[row].objects, totals[row].live, used * 100);
+    printBar(used);
+    printf("\n");
+  }
+  if (unknown > 0)
+    printf("  (%u events on pages the trace does not cover)\n", unknown);
+  printf("\n");
+}
+
+/**
+ * The main function
+ * @param argc number of command line arguments
+ * @param argv array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("Usage: %s <dump-file> [timeline-rows]\n", argv[0]);
+    return 1;
+  }
+  unsigned rows = argc > 2 ? static_cast<unsigned>(atoi(argv[2])) : 20;
+  if (rows == 0)
+    rows = 1;
+
+  SimpleTraceDump trace;
+  if (!SimpleTrace::load(argv[1], trace)) {
+    printf("%s is not a trace dump\n", argv[1]);
+    return 1;
+  }
+
+  printf("objectSize: %llu, blockStride: %llu, ticks/s: %.0f\n",
+         static_cast<unsigned long long>(trace.objectSize),
+         static_cast<unsigned long long>(trace.blockStride),
+         trace.ticksPerSecond);
+  printf("events: %zu of %llu recorded (%llu overwritten)\n\n",
+         trace.events.size(), static_cast<unsigned long long>(trace.recorded),
+         static_cast<unsigned long long>(trace.recorded - trace.events.size()));
+  printLatency(trace, SimpleTraceEvent::ALLOCATE, "allocate");
+  printLatency(trace, SimpleTraceEvent::FREE, "free");
+  printLabels(trace);
+  printTimeline(trace, rows);
+  return 0;
+}